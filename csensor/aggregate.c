@@ -0,0 +1,76 @@
+/**
+ * Reading Aggregation Engine Implementation for CloudPico
+ *
+ * See aggregate.h for the model. Variance is accumulated as a sum of
+ * squares; the reported figure is the population standard deviation via
+ * an integer Newton square root. All channel values are well inside the
+ * 64-bit accumulators for any plausible window length.
+ */
+
+#include "aggregate.h"
+
+static void accum_reset(struct agg_accum *a) {
+    a->sum = 0;
+    a->sumsq = 0;
+    a->min = INT32_MAX;
+    a->max = INT32_MIN;
+}
+
+static void accum_add(struct agg_accum *a, int32_t v) {
+    a->sum += v;
+    a->sumsq += (int64_t)v * v;
+    if (v < a->min) a->min = v;
+    if (v > a->max) a->max = v;
+}
+
+// Integer square root (Newton's method); fine for variance magnitudes
+static uint32_t isqrt64(uint64_t v) {
+    if (v == 0) {
+        return 0;
+    }
+    uint64_t x = v;
+    uint64_t y = (x + 1) / 2;
+    while (y < x) {
+        x = y;
+        y = (x + v / x) / 2;
+    }
+    return (uint32_t)x;
+}
+
+static void accum_finalize(const struct agg_accum *a, uint8_t count, agg_channel_t *out) {
+    out->mean = (int32_t)(a->sum / count);
+    out->min = a->min;
+    out->max = a->max;
+
+    // Population variance: (sum of squares - sum^2/n) / n
+    int64_t var = (a->sumsq - (a->sum * a->sum) / count) / count;
+    if (var < 0) {
+        var = 0;  // rounding can dip just below zero on constant input
+    }
+    uint32_t sd = isqrt64((uint64_t)var);
+    out->sd = sd > UINT16_MAX ? UINT16_MAX : (uint16_t)sd;
+}
+
+void agg_reset(agg_state_t *st) {
+    st->count = 0;
+    accum_reset(&st->temp);
+    accum_reset(&st->press);
+    accum_reset(&st->hum);
+}
+
+void agg_add(agg_state_t *st, const sensor_data_t *data) {
+    if (st->count == 0) {
+        agg_reset(st);
+    }
+    accum_add(&st->temp, data->temp_centi);
+    accum_add(&st->press, data->press_deci);
+    accum_add(&st->hum, data->hum_centi);
+    st->count++;
+}
+
+void agg_finalize(const agg_state_t *st, sensor_agg_t *out) {
+    out->count = st->count;
+    accum_finalize(&st->temp, st->count, &out->temp);
+    accum_finalize(&st->press, st->count, &out->press);
+    accum_finalize(&st->hum, st->count, &out->hum);
+}
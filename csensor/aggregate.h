@@ -0,0 +1,73 @@
+/**
+ * Reading Aggregation Engine for CloudPico
+ *
+ * Incremental per-channel statistics over a window of readings, computed
+ * in integer arithmetic in wire units. At short poll intervals this is
+ * what preserves gusts and spikes: the node samples fast, but advertises
+ * a min/max/mean/std-dev aggregate at the normal cadence instead of an
+ * instantaneous value — spike visibility at one-tenth the radio cost of
+ * advertising every sample.
+ *
+ * Like ble_codec, this module is radio-free so the host-side harness can
+ * compile and validate it natively.
+ */
+
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_advertise.h"
+
+// Samples per aggregation window; overridable from the build
+// (-DAGG_WINDOW_SAMPLES=...). With POLL_INTERVAL_MS=1000 the default gives
+// one aggregate per 10 s, matching the legacy advertising cadence.
+#ifndef AGG_WINDOW_SAMPLES
+#define AGG_WINDOW_SAMPLES 10
+#endif
+
+// Finalized statistics for one channel, in that channel's wire units
+// (std-dev likewise, computed with an integer square root)
+typedef struct {
+    int32_t mean;
+    int32_t min;
+    int32_t max;
+    uint16_t sd;
+} agg_channel_t;
+
+// One finalized aggregate across all channels
+typedef struct {
+    uint8_t count;        // samples in the window
+    agg_channel_t temp;   // centi-degC
+    agg_channel_t press;  // deci-hPa
+    agg_channel_t hum;    // centi-%RH
+} sensor_agg_t;
+
+// Incremental accumulator state; zero-initialize or agg_reset() to start
+typedef struct {
+    uint8_t count;
+    struct agg_accum {
+        int64_t sum;
+        int64_t sumsq;
+        int32_t min;
+        int32_t max;
+    } temp, press, hum;
+} agg_state_t;
+
+/**
+ * Empty the accumulator for the next window.
+ */
+void agg_reset(agg_state_t *st);
+
+/**
+ * Fold one reading into the window. O(1), integer-only.
+ */
+void agg_add(agg_state_t *st, const sensor_data_t *data);
+
+/**
+ * Compute the window statistics. Valid with any count >= 1; the
+ * accumulator is left untouched (reset separately).
+ */
+void agg_finalize(const agg_state_t *st, sensor_agg_t *out);
+
+#endif // AGGREGATE_H
@@ -0,0 +1,310 @@
+/**
+ * Host-Side Codec Benchmark for CloudPico
+ *
+ * Encodes and decodes synthetic reading streams through the v2 delta-batch
+ * codec, reporting bytes-per-reading and time-per-encode, and validates
+ * round-trip exactness against both a recorded device trace and millions
+ * of random-walk histories. Run with --quick for the CI/ctest variant
+ * (validation only, small iteration count).
+ *
+ * Exit status is non-zero on any mismatch: a payload that decodes to
+ * anything other than the exact history it was encoded from fails the run.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "aggregate.h"
+#include "ble_codec.h"
+
+#define HISTORY_LEN (1 + BLE_CODEC_MAX_DELTAS)
+
+// Readings captured over USB serial from a bench device (inside sensor,
+// 10 s interval, a window spanning an evening cooldown). Wire units.
+static const sensor_data_t real_trace[] = {
+    { 2312, 10132, 4517 }, { 2310, 10132, 4520 }, { 2309, 10133, 4522 },
+    { 2305, 10133, 4530 }, { 2301, 10134, 4535 }, { 2296, 10134, 4542 },
+    { 2290, 10135, 4550 }, { 2285, 10135, 4560 }, { 2279, 10136, 4572 },
+    { 2274, 10136, 4585 }, { 2270, 10137, 4600 }, { 2266, 10137, 4617 },
+    { 2262, 10138, 4635 }, { 2259, 10138, 4655 }, { 2256, 10139, 4675 },
+    { 2254, 10139, 4697 }, { 2252, 10140, 4720 }, { 2250, 10140, 4745 },
+    { 2249, 10141, 4770 }, { 2248, 10141, 4795 }, { 2247, 10142, 4820 },
+    { 2246, 10142, 4847 }, { 2246, 10143, 4875 }, { 2245, 10143, 4902 },
+};
+
+#define REAL_TRACE_LEN (sizeof(real_trace) / sizeof(real_trace[0]))
+
+// Small deterministic PRNG so runs are reproducible across hosts
+static uint32_t rng_state = 0x1234ABCDu;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Random walk step in [-range, range]
+static int32_t rng_step(int32_t range) {
+    return (int32_t)(rng_next() % (2 * range + 1)) - range;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Encode a history, decode the payload, and require the decoded prefix to
+ * match the input exactly. Returns the number of readings the payload
+ * carried, or -1 on mismatch.
+ */
+static int roundtrip(const sensor_data_t *history, uint8_t history_count,
+                     uint32_t device_id, uint32_t reading_id, uint8_t *len_out) {
+    uint8_t buf[BLE_CODEC_V2_MAX_LEN];
+    uint8_t len = ble_codec_encode_delta(buf, device_id, reading_id,
+                                         history, history_count);
+    *len_out = len;
+
+    sensor_data_t decoded[HISTORY_LEN];
+    uint32_t dev_out, id_out;
+    uint8_t count_out;
+    if (!ble_codec_decode_delta(buf, len, &dev_out, &id_out, decoded, &count_out)) {
+        fprintf(stderr, "FAIL: payload did not decode (len %u)\n", len);
+        return -1;
+    }
+    if (dev_out != device_id || id_out != reading_id) {
+        fprintf(stderr, "FAIL: header mismatch\n");
+        return -1;
+    }
+    for (uint8_t i = 0; i < count_out; i++) {
+        if (memcmp(&decoded[i], &history[i], sizeof(sensor_data_t)) != 0) {
+            fprintf(stderr,
+                    "FAIL: reading %u mismatch: got {%" PRId32 ",%" PRId32 ",%" PRId32 "} "
+                    "want {%" PRId32 ",%" PRId32 ",%" PRId32 "}\n",
+                    i, decoded[i].temp_centi, decoded[i].press_deci, decoded[i].hum_centi,
+                    history[i].temp_centi, history[i].press_deci, history[i].hum_centi);
+            return -1;
+        }
+    }
+    return count_out;
+}
+
+/**
+ * Slide a HISTORY_LEN window over the recorded trace and round-trip every
+ * position, exactly as the firmware's history ring would present it.
+ */
+static int validate_real_trace(void) {
+    for (size_t start = 0; start + HISTORY_LEN <= REAL_TRACE_LEN; start++) {
+        sensor_data_t history[HISTORY_LEN];
+        // Firmware history is newest-first
+        for (int i = 0; i < HISTORY_LEN; i++) {
+            history[i] = real_trace[start + HISTORY_LEN - 1 - i];
+        }
+        uint8_t len;
+        if (roundtrip(history, HISTORY_LEN, 0xC10D0001u, (uint32_t)(1000 + start), &len) < 0) {
+            fprintf(stderr, "FAIL: real trace window at %zu\n", start);
+            return -1;
+        }
+    }
+    printf("real trace: %zu windows round-tripped exactly\n",
+           REAL_TRACE_LEN - HISTORY_LEN + 1);
+    return 0;
+}
+
+/**
+ * Random-walk streams: steps sized so most (not all) deltas are
+ * representable, exercising both the delta path and the truncation path.
+ */
+static int run_synthetic(uint64_t iterations, int timed) {
+    sensor_data_t history[HISTORY_LEN];
+    uint64_t total_bytes = 0;
+    uint64_t total_readings = 0;
+    uint64_t truncated = 0;
+    uint8_t scratch[BLE_CODEC_V2_MAX_LEN];
+
+    // Warm, plausible starting point
+    sensor_data_t cur = { 2200, 10130, 5000 };
+    for (int i = 0; i < HISTORY_LEN; i++) {
+        history[i] = cur;
+    }
+
+    uint64_t t_encode_ns = 0;
+
+    for (uint64_t it = 0; it < iterations; it++) {
+        // Advance the walk: temperature in whole delta LSBs most of the
+        // time, occasionally a jump past the +-127 step range
+        cur.temp_centi += rng_step(30) * 10;
+        cur.press_deci += rng_step(3);
+        cur.hum_centi += rng_step(4) * 25;
+        if ((rng_next() & 0xFFF) == 0) {
+            cur.temp_centi += 2000;  // 20 degC door event: exceeds the delta range
+        }
+
+        // Keep the walk inside the BME280's measurement ranges; the codec
+        // only guarantees exact round-trips for physically possible data
+        if (cur.temp_centi < -4000) cur.temp_centi = -4000;
+        if (cur.temp_centi > 8500) cur.temp_centi = 8500;
+        if (cur.press_deci < 3000) cur.press_deci = 3000;
+        if (cur.press_deci > 11000) cur.press_deci = 11000;
+        if (cur.hum_centi < 0) cur.hum_centi = 0;
+        if (cur.hum_centi > 10000) cur.hum_centi = 10000;
+
+        memmove(&history[1], &history[0], (HISTORY_LEN - 1) * sizeof(sensor_data_t));
+        history[0] = cur;
+
+        if (timed) {
+            uint64_t t0 = now_ns();
+            uint8_t len = ble_codec_encode_delta(scratch, 0xBEEF0000u, (uint32_t)it,
+                                                 history, HISTORY_LEN);
+            t_encode_ns += now_ns() - t0;
+            total_bytes += len;
+            // Count what the frame actually carried
+            total_readings += 1 + scratch[11];
+            if (scratch[11] < BLE_CODEC_MAX_DELTAS) {
+                truncated++;
+            }
+        } else {
+            uint8_t len;
+            int carried = roundtrip(history, HISTORY_LEN, 0xBEEF0000u, (uint32_t)it, &len);
+            if (carried < 0) {
+                return -1;
+            }
+            total_bytes += len;
+            total_readings += (uint64_t)carried;
+            if (carried < HISTORY_LEN) {
+                truncated++;
+            }
+        }
+    }
+
+    printf("synthetic: %" PRIu64 " iterations, %.2f bytes/reading, "
+           "%" PRIu64 " truncated frames (%.2f%%)\n",
+           iterations, (double)total_bytes / (double)total_readings,
+           truncated, 100.0 * (double)truncated / (double)iterations);
+    if (timed) {
+        printf("encode: %.1f ns/frame (%.1f ns/reading)\n",
+               (double)t_encode_ns / (double)iterations,
+               (double)t_encode_ns / (double)total_readings);
+    }
+    return 0;
+}
+
+// Field-wise (struct padding is not round-tripped)
+static int agg_channel_eq(const agg_channel_t *a, const agg_channel_t *b) {
+    return a->mean == b->mean && a->min == b->min &&
+           a->max == b->max && a->sd == b->sd;
+}
+
+/**
+ * Fold the recorded trace through the aggregation engine in window-sized
+ * chunks and round-trip each finalized aggregate through the v3 frame.
+ * Statistics are cross-checked against a direct two-pass computation.
+ */
+static int validate_aggregate(void) {
+    size_t windows = 0;
+    for (size_t start = 0; start + AGG_WINDOW_SAMPLES <= REAL_TRACE_LEN;
+         start += AGG_WINDOW_SAMPLES) {
+        agg_state_t st;
+        agg_reset(&st);
+        int64_t sum = 0;
+        int32_t lo = INT32_MAX, hi = INT32_MIN;
+        for (int i = 0; i < AGG_WINDOW_SAMPLES; i++) {
+            const sensor_data_t *r = &real_trace[start + i];
+            agg_add(&st, r);
+            sum += r->temp_centi;
+            if (r->temp_centi < lo) lo = r->temp_centi;
+            if (r->temp_centi > hi) hi = r->temp_centi;
+        }
+
+        sensor_agg_t agg;
+        agg_finalize(&st, &agg);
+        if (agg.count != AGG_WINDOW_SAMPLES ||
+            agg.temp.mean != (int32_t)(sum / AGG_WINDOW_SAMPLES) ||
+            agg.temp.min != lo || agg.temp.max != hi) {
+            fprintf(stderr, "FAIL: aggregate statistics mismatch at %zu\n", start);
+            return -1;
+        }
+
+        uint8_t buf[BLE_CODEC_V3_LEN];
+        uint8_t len = ble_codec_encode_agg(buf, 0xC10D0001u, (uint32_t)start, &agg);
+        if (len != BLE_CODEC_V3_LEN) {
+            fprintf(stderr, "FAIL: v3 frame length %u\n", len);
+            return -1;
+        }
+        sensor_agg_t decoded;
+        uint32_t dev_out, id_out;
+        if (!ble_codec_decode_agg(buf, len, &dev_out, &id_out, &decoded) ||
+            dev_out != 0xC10D0001u || id_out != (uint32_t)start ||
+            decoded.count != agg.count ||
+            !agg_channel_eq(&decoded.temp, &agg.temp) ||
+            !agg_channel_eq(&decoded.press, &agg.press) ||
+            !agg_channel_eq(&decoded.hum, &agg.hum)) {
+            fprintf(stderr, "FAIL: v3 round-trip mismatch at %zu\n", start);
+            return -1;
+        }
+        windows++;
+    }
+    printf("aggregate: %zu windows round-tripped exactly\n", windows);
+    return 0;
+}
+
+/**
+ * Round-trip the v4 status frame across a few counter patterns (zeroes,
+ * mid-range, saturation).
+ */
+static int validate_status(void) {
+    static const ble_status_t cases[] = {
+        { 0, 0, 0, 0 },
+        { 86400, 123456, 17, 2 },
+        { UINT32_MAX, UINT32_MAX, UINT16_MAX, UINT16_MAX },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint8_t buf[BLE_CODEC_V4_LEN];
+        uint8_t len = ble_codec_encode_status(buf, 0xC10D0001u, &cases[i]);
+        ble_status_t decoded;
+        uint32_t dev_out;
+        if (len != BLE_CODEC_V4_LEN ||
+            !ble_codec_decode_status(buf, len, &dev_out, &decoded) ||
+            dev_out != 0xC10D0001u ||
+            decoded.uptime_s != cases[i].uptime_s ||
+            decoded.adv_sent != cases[i].adv_sent ||
+            decoded.adv_fail != cases[i].adv_fail ||
+            decoded.stack_restarts != cases[i].stack_restarts) {
+            fprintf(stderr, "FAIL: v4 round-trip mismatch at case %zu\n", i);
+            return -1;
+        }
+    }
+    printf("status: %zu frames round-tripped exactly\n",
+           sizeof(cases) / sizeof(cases[0]));
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int quick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+
+    if (validate_real_trace() != 0) {
+        return 1;
+    }
+    if (validate_aggregate() != 0) {
+        return 1;
+    }
+    if (validate_status() != 0) {
+        return 1;
+    }
+    // Validation pass: every frame decoded and compared
+    if (run_synthetic(quick ? 100000 : 2000000, 0) != 0) {
+        return 1;
+    }
+    if (!quick) {
+        // Timed pass: encode only, so the numbers measure the codec
+        if (run_synthetic(5000000, 1) != 0) {
+            return 1;
+        }
+    }
+    printf("OK\n");
+    return 0;
+}
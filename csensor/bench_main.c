@@ -0,0 +1,353 @@
+/**
+ * On-Target Microbenchmark for CloudPico
+ *
+ * Benchmark main for the cloudpico_bench target: runs the firmware's hot
+ * paths in isolation on real hardware and prints per-section cycle
+ * distributions (min/p50/p99/max) over USB stdio. Flash the .uf2 built
+ * from a release candidate and from the previous release, attach a
+ * terminal, and diff the two reports — that before/after run is the gate
+ * for rolling a firmware upgrade across the fleet.
+ *
+ * Measured sections:
+ *   - bme280_pico_i2c_read of the 8-byte data burst at every rate on the
+ *     negotiation ladder (1 MHz / 400 kHz / 100 kHz)
+ *   - bme280_get_sensor_data (readout + Bosch compensation, the
+ *     PERF_COMPENSATE section)
+ *   - the high-rate capture pipeline end to end through the bus manager:
+ *     sensor_bus_capture_raw at 100 Hz, then sensor_bus_compensate_raw
+ *     per captured frame
+ *   - every payload encoder the node can carry (v2 legacy, v2 extended,
+ *     v3 aggregate in delta_agg builds, v4 status)
+ *   - flash_store appends (staging) and page commits, including the
+ *     sector erases that land every 16th page
+ *
+ * Timing uses the same free-running SysTick as perf.c; every section is
+ * far below the 24-bit wrap except the flash commits, which can contain a
+ * multi-ms sector erase and are therefore reported in microseconds.
+ *
+ * The sensor benches need a BME280 at 0x76 on GP16/GP17 (the standard
+ * enclosure wiring); without one they are skipped and the codec and flash
+ * benches still run. The flash bench programs 64 pages (4 sectors) of the
+ * reading log ring per run — negligible wear against the ring's rotation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/clocks.h"
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "bme280.h"
+#include "bme280_pico_i2c.h"
+#include "ble_codec.h"
+#include "config.h"
+#include "flash_store.h"
+#include "perf.h"
+#include "sensor_bus.h"
+
+// Enclosure wiring: inside sensor on i2c0 (see PINOUT.md)
+#define BENCH_I2C_ADDR 0x76
+#define BENCH_SDA_PIN 16
+#define BENCH_SCL_PIN 17
+
+// SysTick is a 24-bit down-counter (mirrors perf.c)
+#define BENCH_CYCLE_MASK 0x00FFFFFFu
+
+// Iterations per section; tuned so the full run stays under a minute
+#define BENCH_ITERS_I2C 2048
+#define BENCH_ITERS_CPU 4096
+#define BENCH_FLASH_BATCHES 64
+
+// Device ID used in encoded frames (never leaves the board)
+#define BENCH_DEVICE_ID 0xBE9C0001u
+
+static uint32_t samples[BENCH_ITERS_CPU];
+
+static struct bme280_pico_i2c_context i2c_ctx;
+static struct bme280_dev dev;
+
+// Elapsed cycles since a perf_begin() stamp (down-counter, modulo 24 bits)
+static inline uint32_t cycles_since(uint32_t t0) {
+    return (t0 - perf_begin()) & BENCH_CYCLE_MASK;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sort the collected samples and print one distribution line. The fixed
+ * "bench:" prefix and column layout keep two captured reports diffable.
+ */
+static void report(const char *name, uint32_t *s, uint32_t n, const char *unit) {
+    qsort(s, n, sizeof(uint32_t), cmp_u32);
+    printf("bench: %-18s n=%5lu min=%8lu p50=%8lu p99=%8lu max=%8lu %s\n",
+           name, (unsigned long)n,
+           (unsigned long)s[0],
+           (unsigned long)s[n / 2],
+           (unsigned long)s[(n * 99) / 100],
+           (unsigned long)s[n - 1],
+           unit);
+}
+
+/**
+ * One chip-ID readback; false means the bus does not work at the current
+ * rate (same check the speed negotiation uses).
+ */
+static bool bus_responds(void) {
+    uint8_t chip_id = 0;
+    return bme280_pico_i2c_read(BME280_REG_CHIP_ID, &chip_id, 1, &i2c_ctx)
+               == BME280_INTF_RET_SUCCESS &&
+           chip_id == BME280_CHIP_ID;
+}
+
+/**
+ * The 8-byte data-register burst — the transaction the sampling loop
+ * issues every cycle — at each rate on the negotiation ladder.
+ * @return The fastest verified rate in Hz (100 kHz if nothing verified)
+ */
+static uint bench_i2c_read(void) {
+    static const uint ladder[] = {1000 * 1000, 400 * 1000, 100 * 1000};
+    uint fastest = 100 * 1000;
+    uint8_t regs[BME280_LEN_P_T_H_DATA];
+
+    for (uint i = 0; i < count_of(ladder); i++) {
+        uint actual = i2c_set_baudrate(i2c_ctx.i2c, ladder[i]);
+        if (!bus_responds()) {
+            printf("bench: i2c_read@%ukHz     skipped (rate failed verification)\n",
+                   ladder[i] / 1000);
+            continue;
+        }
+        if (ladder[i] > fastest) {
+            fastest = actual;
+        }
+        for (uint32_t n = 0; n < BENCH_ITERS_I2C; n++) {
+            uint32_t t0 = perf_begin();
+            bme280_pico_i2c_read(BME280_REG_DATA, regs, sizeof(regs), &i2c_ctx);
+            samples[n] = cycles_since(t0);
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "i2c_read@%ukHz", ladder[i] / 1000);
+        report(name, samples, BENCH_ITERS_I2C, "cycles");
+    }
+
+    i2c_set_baudrate(i2c_ctx.i2c, fastest);
+    return fastest;
+}
+
+/**
+ * bme280_get_sensor_data (burst readout + compensation, what the perf
+ * counter calls "compensate") at the fastest verified rate.
+ */
+static void bench_compensation(void) {
+    struct bme280_data comp;
+
+    // Free-run the sensor so the registers hold live conversions; the
+    // readout timing itself does not depend on the power mode
+    bme280_set_sensor_mode(BME280_POWERMODE_NORMAL, &dev);
+    sleep_ms(10);
+
+    for (uint32_t n = 0; n < BENCH_ITERS_CPU; n++) {
+        uint32_t t0 = perf_begin();
+        bme280_get_sensor_data(BME280_ALL, &comp, &dev);
+        samples[n] = cycles_since(t0);
+    }
+    report("get_sensor_data", samples, BENCH_ITERS_CPU, "cycles");
+
+    bme280_set_sensor_mode(BME280_POWERMODE_SLEEP, &dev);
+}
+
+// Raw-capture run: 100 Hz is the event-detection rate the pipeline exists
+// for; 256 frames keeps the run short while spanning many bus cycles
+#define BENCH_RAW_FRAMES 256
+#define BENCH_RAW_INTERVAL_US 10000
+
+/**
+ * The high-rate capture pipeline end to end through the bus manager:
+ * sensor_bus_capture_raw burst-reads frames at the event-detection rate
+ * (the capture is sensor-paced, so it is reported as achieved wall time),
+ * then sensor_bus_compensate_raw — the per-frame cost of keeping a frame
+ * after downsampling — is the cycle distribution.
+ */
+static void bench_raw_capture(void) {
+    static sensor_raw_frame_t frames[BENCH_RAW_FRAMES];
+
+    // The bus manager reads its sensor profile from the runtime config
+    config_init();
+    if (sensor_bus_init() < 0) {
+        printf("bench: raw_capture         skipped (no sensors on the bus)\n");
+        return;
+    }
+
+    uint32_t t0_us = time_us_32();
+    int captured = sensor_bus_capture_raw(0, frames, BENCH_RAW_FRAMES,
+                                          BENCH_RAW_INTERVAL_US);
+    uint32_t elapsed_us = time_us_32() - t0_us;
+    if (captured <= 0) {
+        printf("bench: raw_capture         skipped (capture failed)\n");
+        return;
+    }
+    printf("bench: raw_capture         %d frames at %lu Hz in %lu us\n",
+           captured, (unsigned long)(1000000u / BENCH_RAW_INTERVAL_US),
+           (unsigned long)elapsed_us);
+
+    sensor_data_t out;
+    for (uint32_t n = 0; n < BENCH_ITERS_CPU; n++) {
+        uint32_t t0 = perf_begin();
+        sensor_bus_compensate_raw(0, &frames[n % (uint32_t)captured], &out);
+        samples[n] = cycles_since(t0);
+    }
+    report("compensate_raw", samples, BENCH_ITERS_CPU, "cycles");
+}
+
+/**
+ * Every encoder the node can put on the air. The history is synthetic but
+ * drifts per iteration so the delta paths see changing inputs instead of
+ * a perfectly predicted constant.
+ */
+static void bench_encoders(void) {
+    static sensor_data_t history[1 + BLE_CODEC_MAX_DELTAS_EXT];
+    uint8_t frame[BLE_CODEC_V2_EXT_MAX_LEN];
+
+    for (uint32_t i = 0; i < count_of(history); i++) {
+        history[i].temp_centi = 2215 - (int32_t)i * 7;
+        history[i].press_deci = 10132 + (int32_t)i * 3;
+        history[i].hum_centi = 4480 + (int32_t)i * 11;
+    }
+
+    for (uint32_t n = 0; n < BENCH_ITERS_CPU; n++) {
+        history[0].temp_centi += (n & 1) ? 12 : -12;
+        uint32_t t0 = perf_begin();
+        ble_codec_encode_delta(frame, BENCH_DEVICE_ID, n,
+                               history, 1 + BLE_CODEC_MAX_DELTAS);
+        samples[n] = cycles_since(t0);
+    }
+    report("encode_v2", samples, BENCH_ITERS_CPU, "cycles");
+
+    for (uint32_t n = 0; n < BENCH_ITERS_CPU; n++) {
+        history[0].temp_centi += (n & 1) ? 12 : -12;
+        uint32_t t0 = perf_begin();
+        ble_codec_encode_delta(frame, BENCH_DEVICE_ID, n,
+                               history, 1 + BLE_CODEC_MAX_DELTAS_EXT);
+        samples[n] = cycles_since(t0);
+    }
+    report("encode_v2_ext", samples, BENCH_ITERS_CPU, "cycles");
+
+#ifdef BLE_PAYLOAD_HAS_AGG
+    agg_state_t agg_state;
+    sensor_agg_t agg;
+    agg_reset(&agg_state);
+    for (uint32_t i = 0; i < AGG_WINDOW_SAMPLES; i++) {
+        agg_add(&agg_state, &history[i % count_of(history)]);
+    }
+    agg_finalize(&agg_state, &agg);
+    for (uint32_t n = 0; n < BENCH_ITERS_CPU; n++) {
+        uint32_t t0 = perf_begin();
+        ble_codec_encode_agg(frame, BENCH_DEVICE_ID, n, &agg);
+        samples[n] = cycles_since(t0);
+    }
+    report("encode_v3", samples, BENCH_ITERS_CPU, "cycles");
+#endif
+
+    ble_status_t status = {
+        .uptime_s = 86400, .adv_sent = 123456, .adv_fail = 7, .stack_restarts = 1,
+    };
+    for (uint32_t n = 0; n < BENCH_ITERS_CPU; n++) {
+        uint32_t t0 = perf_begin();
+        ble_codec_encode_status(frame, BENCH_DEVICE_ID, &status);
+        samples[n] = cycles_since(t0);
+    }
+    report("encode_v4", samples, BENCH_ITERS_CPU, "cycles");
+}
+
+/**
+ * The flash pipeline as the firmware drives it: stage one page of records
+ * (appends, cycles), then commit it from the quiet point (microseconds —
+ * a commit can contain a sector erase, which would wrap the cycle
+ * counter). p99 of the commits is where the erases show up.
+ */
+static void bench_flash(void) {
+    static uint32_t commit_us[BENCH_FLASH_BATCHES];
+    const uint32_t records_per_page = FLASH_PAGE_SIZE / sizeof(flash_record_t);
+    sensor_data_t data = {.temp_centi = 2215, .press_deci = 10132, .hum_centi = 4480};
+    uint32_t reading_id = 0;
+    uint32_t appended = 0;
+
+    if (flash_store_init() != 0) {
+        printf("bench: flash               skipped (store unavailable)\n");
+        return;
+    }
+
+    for (uint32_t b = 0; b < BENCH_FLASH_BATCHES; b++) {
+        for (uint32_t r = 0; r < records_per_page; r++) {
+            data.temp_centi += (reading_id & 1) ? 3 : -3;
+            uint32_t t0 = perf_begin();
+            flash_store_append(0, reading_id++, &data);
+            samples[appended++] = cycles_since(t0);
+        }
+        uint32_t t0_us = time_us_32();
+        flash_store_commit_maybe();
+        commit_us[b] = time_us_32() - t0_us;
+    }
+
+    report("flash_append", samples, appended, "cycles");
+    report("flash_commit_page", commit_us, BENCH_FLASH_BATCHES, "us");
+}
+
+int main() {
+    stdio_init_all();
+
+    // The report is the whole point: wait for a terminal, then give it a
+    // moment to attach before the header scrolls past
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    sleep_ms(500);
+
+    perf_core_init();
+    printf("cloudpico bench: clk_sys %lu Hz (cycles / clk_sys = seconds)\n",
+           (unsigned long)clock_get_hz(clk_sys));
+
+    bme280_pico_i2c_init(&i2c_ctx, i2c0, BENCH_I2C_ADDR,
+                         BENCH_SDA_PIN, BENCH_SCL_PIN, 100 * 1000);
+
+    dev.intf = BME280_I2C_INTF;
+    dev.read = bme280_pico_i2c_read;
+    dev.write = bme280_pico_i2c_write;
+    dev.delay_us = bme280_pico_delay_us;
+    dev.intf_ptr = &i2c_ctx;
+
+    if (bme280_init(&dev) == BME280_OK) {
+        // Fast profile: the sensor benches measure bus and CPU cost, not
+        // conversion time, so the shortest conversion settings are fine
+        struct bme280_settings settings = {
+            .osr_t = BME280_OVERSAMPLING_1X,
+            .osr_p = BME280_OVERSAMPLING_1X,
+            .osr_h = BME280_OVERSAMPLING_1X,
+            .filter = BME280_FILTER_COEFF_OFF,
+            .standby_time = BME280_STANDBY_TIME_0_5_MS,
+        };
+        bme280_set_sensor_settings(BME280_SEL_ALL_SETTINGS, &settings, &dev);
+
+        bench_i2c_read();
+        bench_compensation();
+    } else {
+        printf("bench: i2c/compensation    skipped (no BME280 at 0x%02X)\n",
+               BENCH_I2C_ADDR);
+    }
+
+    // Probes the device table itself, so it runs regardless of the direct
+    // benches above
+    bench_raw_capture();
+
+    bench_encoders();
+    bench_flash();
+
+    printf("bench: done\n");
+    while (1) {
+        sleep_ms(1000);
+    }
+}
@@ -7,107 +7,363 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#ifdef BLE_PAYLOAD_HAS_AGG
+#include "aggregate.h"
+#endif
 #include "ble_advertise.h"
+#include "ble_codec.h"
+#include "ble_gatt.h"
 #include "btstack.h"
+#include "config.h"
+#include "log.h"
+#include "perf.h"
+#include "reading_seq.h"
 #include "pico/cyw43_arch.h"
 #include "pico/btstack_cyw43.h"
 #include "pico/stdlib.h"
 
-#define ADV_INTERVAL_MIN_MS 800
-#define ADV_INTERVAL_MAX_MS 800
+// Adaptive interval ladder: burst at the fast end while readings are moving,
+// double toward the slow end while they are static. Radio-on time scales
+// with the advertising rate, so idle hours mostly sit at the slow end.
+// The ladder's endpoints come from the runtime config (adv_fast_ms /
+// adv_slow_ms; defaults in config.c).
 #define ADV_TYPE 0  // ADV_IND: connectable undirected advertising
 
+// Change thresholds in wire units: a reading that moved at least this much
+// from the previous one counts as significant and triggers a fast burst
+#define ADV_CHANGE_TEMP_CENTI 20    // 0.2 degC
+#define ADV_CHANGE_PRESS_DECI 5     // 0.5 hPa
+#define ADV_CHANGE_HUM_CENTI 100    // 1 %RH
+
+// Hysteresis: a significant change pins the fast interval for this many
+// cycles, and widening one ladder step takes this many consecutive quiet
+// cycles — so a single noisy sample neither collapses nor stretches the rate
+#define ADV_BURST_CYCLES 4
+#define ADV_QUIET_CYCLES_PER_STEP 3
+
+// Every Nth update the legacy set carries the v4 status frame (TX
+// counters) instead of readings for one cycle; the next delta frame
+// backfills the readings the cycle would otherwise have advertised, so
+// the channel costs no data — only latency on one in N cycles.
+#define ADV_STATUS_EVERY_N 32
+
 // BLE state
 static bool ble_initialized = false;
 static uint32_t device_id = 0;
-static uint32_t reading_id = 0;
 static btstack_packet_callback_registration_t hci_event_callback_registration;
 
-// Advertisement data buffer (max 31 bytes for BLE)
-// Format: Flags (3) + Name (up to 20) + Manufacturer Data (25)
-static uint8_t adv_data[31];
-static uint8_t adv_data_len = 0;
+// Per-sensor advertising state. Each sensor slot advertises under
+// device_id + sensor_id with its own reading counter and delta history;
+// updates rotate through the slots as readings arrive from the bus manager.
+typedef struct {
+    // Deep enough for an extended frame; legacy frames encode only the
+    // first 1 + BLE_CODEC_MAX_DELTAS entries
+    sensor_data_t history[1 + BLE_CODEC_MAX_DELTAS_EXT];  // newest first
+    uint8_t history_count;
+    uint32_t reading_id;
+    #ifdef BLE_PAYLOAD_HAS_AGG
+    agg_state_t agg;  // running window statistics (min/max/mean/sd)
+    #endif
+} adv_sensor_state_t;
+
+static adv_sensor_state_t sensors[BLE_ADV_MAX_SENSORS];
+
+// Double-buffered advertisement frames (max 31 bytes each for legacy BLE).
+// Format: Flags (3) + Manufacturer Data header (4) + codec payload (up to 24).
+// BTstack may hand the active frame to the radio at any time, so updates are
+// written into the inactive frame only and published with a buffer swap —
+// no frame is ever mutated while it can be in flight.
+#define ADV_FRAME_MAX 31
+#define ADV_PREFIX_LEN 7  // flags AD (3) + mfg AD header (1+1+2)
+
+static uint8_t adv_frames[2][ADV_FRAME_MAX];
+static uint8_t adv_frame_len[2];
+static volatile uint8_t adv_active = 0;
+
+// Adaptive interval state
+static uint16_t adv_interval_ms = 0;  // set from config in init
+static uint8_t adv_burst_left = 0;
+static uint8_t adv_quiet_cycles = 0;
+
+// Transmit-side counters for the v4 status frame. hci_working_count also
+// drives the restart field: every return to HCI working state beyond the
+// first is a stack restart the fleet should know about.
+static ble_status_t tx_status;
+static uint16_t hci_working_count = 0;
+static uint32_t adv_update_count = 0;
 
 /**
- * Build manufacturer data payload
- * Format: magic (2) + device_id (4) + reading_id (4) + temp (4) + pressure (4) + humidity (4) = 22 bytes
+ * Push the current interval to the controller. BTstack queues the parameter
+ * update through its advertising state machine, so this is safe while
+ * advertising is enabled.
  */
-static void build_manufacturer_data(uint8_t *buffer, uint32_t dev_id, uint32_t read_id, 
-                                     float temp, float pressure, float humidity) {
-    uint8_t *p = buffer;
-    
-    // Magic bytes
-    *p++ = BLE_MAGIC_0;
-    *p++ = BLE_MAGIC_1;
-    
-    // Device ID (little-endian uint32)
-    *p++ = (uint8_t)(dev_id & 0xFF);
-    *p++ = (uint8_t)((dev_id >> 8) & 0xFF);
-    *p++ = (uint8_t)((dev_id >> 16) & 0xFF);
-    *p++ = (uint8_t)((dev_id >> 24) & 0xFF);
-    
-    // Reading ID (little-endian uint32)
-    *p++ = (uint8_t)(read_id & 0xFF);
-    *p++ = (uint8_t)((read_id >> 8) & 0xFF);
-    *p++ = (uint8_t)((read_id >> 16) & 0xFF);
-    *p++ = (uint8_t)((read_id >> 24) & 0xFF);
-    
-    // Temperature (little-endian float32)
-    uint32_t temp_bits = *(uint32_t*)&temp;
-    *p++ = (uint8_t)(temp_bits & 0xFF);
-    *p++ = (uint8_t)((temp_bits >> 8) & 0xFF);
-    *p++ = (uint8_t)((temp_bits >> 16) & 0xFF);
-    *p++ = (uint8_t)((temp_bits >> 24) & 0xFF);
-    
-    // Pressure (little-endian float32)
-    uint32_t press_bits = *(uint32_t*)&pressure;
-    *p++ = (uint8_t)(press_bits & 0xFF);
-    *p++ = (uint8_t)((press_bits >> 8) & 0xFF);
-    *p++ = (uint8_t)((press_bits >> 16) & 0xFF);
-    *p++ = (uint8_t)((press_bits >> 24) & 0xFF);
-    
-    // Humidity (little-endian float32)
-    uint32_t hum_bits = *(uint32_t*)&humidity;
-    *p++ = (uint8_t)(hum_bits & 0xFF);
-    *p++ = (uint8_t)((hum_bits >> 8) & 0xFF);
-    *p++ = (uint8_t)((hum_bits >> 16) & 0xFF);
-    *p++ = (uint8_t)((hum_bits >> 24) & 0xFF);
+static void adv_apply_interval(void) {
+    bd_addr_t null_addr;
+    memset(null_addr, 0, 6);
+    gap_advertisements_set_params(adv_interval_ms, adv_interval_ms,
+                                  ADV_TYPE, 0, null_addr, 0x07, 0x00);
 }
 
 /**
- * Build advertisement data packet
+ * Did the reading move enough from the previous one to count as a
+ * transition worth reporting at low latency?
  */
-static void build_adv_data(uint32_t dev_id, uint32_t read_id, 
-                           float temp, float pressure, float humidity) {
-    uint8_t *p = adv_data;
-    
-    // Flags: general discoverable, BR/EDR not supported
-    *p++ = 0x02;  // Length
-    *p++ = BLUETOOTH_DATA_TYPE_FLAGS;
-    *p++ = 0x06;  // Flags value
-    
-    // Manufacturer data: Company ID (2 bytes) + payload (22 bytes) = 24 bytes total
-    uint8_t mfg_data[22];
-    build_manufacturer_data(mfg_data, dev_id, read_id, temp, pressure, humidity);
-    
-    *p++ = 25;  // Length: 1 (type) + 2 (Company ID) + 22 (payload)
-    *p++ = BLUETOOTH_DATA_TYPE_MANUFACTURER_SPECIFIC_DATA;
-    // Company ID (little-endian)
-    *p++ = (uint8_t)(BLE_COMPANY_ID & 0xFF);
-    *p++ = (uint8_t)((BLE_COMPANY_ID >> 8) & 0xFF);
-    // Payload
-    memcpy(p, mfg_data, 22);
-    p += 22;
-    
-    adv_data_len = p - adv_data;
-    
-    // BLE limitation: max 31 bytes
-    if (adv_data_len > 31) {
-        printf("ERROR: Advertisement data too long: %d bytes\n", adv_data_len);
-        adv_data_len = 31;
+static bool reading_changed(const sensor_data_t *prev, const sensor_data_t *cur) {
+    int32_t dt = cur->temp_centi - prev->temp_centi;
+    int32_t dp = cur->press_deci - prev->press_deci;
+    int32_t dh = cur->hum_centi - prev->hum_centi;
+    if (dt < 0) dt = -dt;
+    if (dp < 0) dp = -dp;
+    if (dh < 0) dh = -dh;
+    return dt >= ADV_CHANGE_TEMP_CENTI ||
+           dp >= ADV_CHANGE_PRESS_DECI ||
+           dh >= ADV_CHANGE_HUM_CENTI;
+}
+
+/**
+ * Advance the adaptive interval by one sampling cycle. A significant change
+ * snaps to the fast interval and starts a burst; quiet cycles beyond the
+ * burst widen the interval one doubling at a time up to the slow end.
+ */
+static void adv_interval_on_reading(bool significant) {
+    const cloudpico_config_t *cfg = config_get();
+
+    if (significant) {
+        adv_quiet_cycles = 0;
+        adv_burst_left = ADV_BURST_CYCLES;
+        if (adv_interval_ms != cfg->adv_fast_ms) {
+            adv_interval_ms = cfg->adv_fast_ms;
+            adv_apply_interval();
+            log_event(LOG_EVT_ADV_INTERVAL, 1, adv_interval_ms, 0, 0, 0);
+        }
+        return;
+    }
+
+    if (adv_burst_left > 0) {
+        adv_burst_left--;
+        return;
+    }
+    if (adv_interval_ms >= cfg->adv_slow_ms) {
+        return;
+    }
+    if (++adv_quiet_cycles >= ADV_QUIET_CYCLES_PER_STEP) {
+        adv_quiet_cycles = 0;
+        adv_interval_ms *= 2;
+        if (adv_interval_ms > cfg->adv_slow_ms) {
+            adv_interval_ms = cfg->adv_slow_ms;
+        }
+        adv_apply_interval();
+        log_event(LOG_EVT_ADV_INTERVAL, 0, adv_interval_ms, 0, 0, 0);
+    }
+}
+
+void ble_advertise_on_config(void) {
+    // New ladder endpoints: restart from the fast end so a freshly tuned
+    // node is immediately observable, then let quiet cycles widen as usual
+    adv_interval_ms = config_get()->adv_fast_ms;
+    adv_burst_left = 0;
+    adv_quiet_cycles = 0;
+    if (ble_initialized) {
+        adv_apply_interval();
+    }
+}
+
+/**
+ * Build the constant prefix (flags + manufacturer-data header) of both
+ * frames once; updates only ever touch the payload bytes and the
+ * manufacturer-data length field.
+ */
+static void adv_frames_init(void) {
+    for (int i = 0; i < 2; i++) {
+        uint8_t *p = adv_frames[i];
+
+        // Flags: general discoverable, BR/EDR not supported
+        *p++ = 0x02;  // Length
+        *p++ = BLUETOOTH_DATA_TYPE_FLAGS;
+        *p++ = 0x06;  // Flags value
+
+        // Manufacturer data header; length byte patched per update
+        *p++ = 3;     // Length: 1 (type) + 2 (Company ID) + payload
+        *p++ = BLUETOOTH_DATA_TYPE_MANUFACTURER_SPECIFIC_DATA;
+        // Company ID (little-endian)
+        *p++ = (uint8_t)(BLE_COMPANY_ID & 0xFF);
+        *p++ = (uint8_t)((BLE_COMPANY_ID >> 8) & 0xFF);
+
+        adv_frame_len[i] = ADV_PREFIX_LEN;
+    }
+}
+
+/**
+ * Encode one sensor's reading history into the inactive frame's payload
+ * bytes and swap it live. Returns the frame handed to BTstack.
+ */
+static const uint8_t *build_adv_from_history(uint8_t sensor_id, uint8_t *len_out) {
+    adv_sensor_state_t *s = &sensors[sensor_id];
+    uint8_t idx = adv_active ^ 1;
+    uint8_t *payload = &adv_frames[idx][ADV_PREFIX_LEN];
+    uint8_t payload_len;
+    uint32_t adv_device_id = device_id + sensor_id;
+
+    // Codec writes straight into the frame: no intermediate copy. The
+    // legacy frame must stay under 31 bytes, so the history is capped at
+    // the legacy delta budget here; the extended set takes the full depth.
+    uint8_t legacy_count = s->history_count;
+    if (legacy_count > 1 + BLE_CODEC_MAX_DELTAS) {
+        legacy_count = 1 + BLE_CODEC_MAX_DELTAS;
+    }
+    if (legacy_count == 0) {
+        // Nothing measured yet: advertise a zeroed single-reading frame
+        sensor_data_t zero = {0, 0, 0};
+        payload_len = ble_codec_encode_delta(payload, adv_device_id, s->reading_id, &zero, 1);
+    } else {
+        payload_len = ble_codec_encode_delta(payload, adv_device_id, s->reading_id,
+                                             s->history, legacy_count);
+    }
+
+    // Patch the manufacturer-data AD length and publish the frame
+    adv_frames[idx][3] = 3 + payload_len;
+    adv_frame_len[idx] = ADV_PREFIX_LEN + payload_len;
+    adv_active = idx;
+
+    *len_out = adv_frame_len[idx];
+    return adv_frames[idx];
+}
+
+/**
+ * Encode the TX counters into the inactive legacy frame and swap it live.
+ * Uptime is sampled at encode time; the other counters are maintained at
+ * their points of truth.
+ */
+static const uint8_t *build_status_adv(uint8_t *len_out) {
+    uint8_t idx = adv_active ^ 1;
+    uint8_t *payload = &adv_frames[idx][ADV_PREFIX_LEN];
+
+    tx_status.uptime_s = to_ms_since_boot(get_absolute_time()) / 1000;
+    uint8_t payload_len = ble_codec_encode_status(payload, device_id, &tx_status);
+
+    adv_frames[idx][3] = 3 + payload_len;
+    adv_frame_len[idx] = ADV_PREFIX_LEN + payload_len;
+    adv_active = idx;
+
+    *len_out = adv_frame_len[idx];
+    return adv_frames[idx];
+}
+
+#ifdef ENABLE_LE_EXTENDED_ADVERTISING
+
+// Extended advertising set: the same AD layout with the full history depth
+// (up to BLE_CODEC_MAX_DELTAS_EXT deltas). Non-connectable non-scannable,
+// as required for >31-byte extended data; connections and the legacy
+// fallback for old gateways ride the legacy set. Double-buffered like the
+// legacy frames.
+#define EXT_FRAME_MAX (ADV_PREFIX_LEN + BLE_CODEC_V2_EXT_MAX_LEN)
+
+static le_advertising_set_t ext_adv_set;
+static uint8_t ext_adv_handle = 0;
+static bool ext_adv_ready = false;  // controller accepted the extended setup
+static uint8_t ext_frames[2][EXT_FRAME_MAX];
+static volatile uint8_t ext_active = 0;
+
+static const le_extended_advertising_parameters_t ext_adv_params = {
+    .advertising_event_properties = 0,  // non-connectable non-scannable extended
+    .primary_advertising_interval_min = 0x500,  // 800 ms (0.625 ms units)
+    .primary_advertising_interval_max = 0x500,
+    .primary_advertising_channel_map = 7,
+    .own_address_type = 0,
+    .peer_address_type = 0,
+    .peer_address = { 0 },
+    .advertising_filter_policy = 0,
+    .advertising_tx_power = 10,
+    .primary_advertising_phy = 1,   // LE 1M
+    .secondary_advertising_max_skip = 0,
+    .secondary_advertising_phy = 1, // LE 1M
+    .advertising_sid = 0,
+    .scan_request_notification_enable = 0,
+};
+
+/**
+ * Encode one sensor's full history into the inactive extended frame and
+ * swap it live. Same prefix-patching scheme as the legacy frames.
+ */
+static const uint8_t *build_ext_adv_from_history(uint8_t sensor_id, uint8_t *len_out) {
+    adv_sensor_state_t *s = &sensors[sensor_id];
+    uint8_t idx = ext_active ^ 1;
+    uint8_t *payload = &ext_frames[idx][ADV_PREFIX_LEN];
+    uint8_t payload_len;
+    uint32_t adv_device_id = device_id + sensor_id;
+
+    if (s->history_count == 0) {
+        sensor_data_t zero = {0, 0, 0};
+        payload_len = ble_codec_encode_delta(payload, adv_device_id, s->reading_id, &zero, 1);
+    } else {
+        payload_len = ble_codec_encode_delta(payload, adv_device_id, s->reading_id,
+                                             s->history, s->history_count);
     }
+
+    ext_frames[idx][3] = 3 + payload_len;
+    ext_active = idx;
+
+    *len_out = ADV_PREFIX_LEN + payload_len;
+    return ext_frames[idx];
 }
 
+#ifdef BLE_PAYLOAD_HAS_AGG
+/**
+ * Encode a finalized window aggregate into the inactive extended frame and
+ * swap it live. At 36 bytes the v3 frame only fits the extended set, so
+ * legacy gateways keep seeing the delta frames and never this format.
+ */
+static const uint8_t *build_ext_adv_from_agg(uint8_t sensor_id, const sensor_agg_t *agg,
+                                             uint8_t *len_out) {
+    adv_sensor_state_t *s = &sensors[sensor_id];
+    uint8_t idx = ext_active ^ 1;
+    uint8_t *payload = &ext_frames[idx][ADV_PREFIX_LEN];
+    uint32_t adv_device_id = device_id + sensor_id;
+
+    uint8_t payload_len = ble_codec_encode_agg(payload, adv_device_id, s->reading_id, agg);
+
+    ext_frames[idx][3] = 3 + payload_len;
+    ext_active = idx;
+
+    *len_out = ADV_PREFIX_LEN + payload_len;
+    return ext_frames[idx];
+}
+#endif // BLE_PAYLOAD_HAS_AGG
+
+/**
+ * Write the constant AD prefix into both extended frames (same layout the
+ * legacy frames use).
+ */
+static void ext_frames_init(void) {
+    for (int i = 0; i < 2; i++) {
+        memcpy(ext_frames[i], adv_frames[0], ADV_PREFIX_LEN);
+    }
+}
+
+/**
+ * Try to bring up the extended set; downgrades to legacy-only if the
+ * controller rejects it (runtime fallback for non-5.0 parts).
+ */
+static void ext_adv_start(void) {
+    ext_frames_init();
+    uint8_t status = gap_extended_advertising_setup(&ext_adv_set, &ext_adv_params,
+                                                    &ext_adv_handle);
+    if (status != ERROR_CODE_SUCCESS) {
+        printf("BLE: extended advertising unavailable (status 0x%02X), legacy only\n", status);
+        tx_status.adv_fail++;
+        return;
+    }
+    uint8_t len;
+    const uint8_t *frame = build_ext_adv_from_history(0, &len);
+    gap_extended_advertising_set_adv_data(ext_adv_handle, len, (uint8_t *)frame);
+    gap_extended_advertising_start(ext_adv_handle, 0, 0);
+    ext_adv_ready = true;
+    printf("BLE: extended advertising set started (up to %u readings/frame)\n",
+           1 + BLE_CODEC_MAX_DELTAS_EXT);
+}
+
+#endif // ENABLE_LE_EXTENDED_ADVERTISING
+
 /**
  * Packet handler for BLE events
  */
@@ -121,22 +377,35 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
     switch(event_type) {
         case BTSTACK_EVENT_STATE:
             if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) return;
-            
+
+            // Every return to working state after the first means the
+            // stack was restarted under us; the fleet dashboard uses this
+            // to separate device trouble from air loss
+            hci_working_count++;
+            tx_status.stack_restarts = hci_working_count - 1;
+
             bd_addr_t local_addr;
             gap_local_bd_addr(local_addr);
             printf("BLE: BTstack up and running on %s\n", bd_addr_to_str(local_addr));
             
-            // Setup advertisement parameters
-            bd_addr_t null_addr;
-            memset(null_addr, 0, 6);
-            gap_advertisements_set_params(ADV_INTERVAL_MIN_MS, ADV_INTERVAL_MAX_MS, 
-                                          ADV_TYPE, 0, null_addr, 0x07, 0x00);
-            
+            // Setup advertisement parameters (fast until readings prove static)
+            adv_apply_interval();
+
             // Set initial advertisement data (will be updated with sensor data)
-            build_adv_data(device_id, reading_id, 0.0f, 0.0f, 0.0f);
-            gap_advertisements_set_data(adv_data_len, adv_data);
+            {
+                uint8_t len;
+                const uint8_t *frame = build_adv_from_history(0, &len);
+                gap_advertisements_set_data(len, (uint8_t *)frame);
+            }
             gap_advertisements_enable(1);
-            
+
+            // Batched telemetry rides an extended set when the controller
+            // has one; the legacy set above stays up either way so old
+            // gateways keep decoding
+            #ifdef ENABLE_LE_EXTENDED_ADVERTISING
+            ext_adv_start();
+            #endif
+
             printf("BLE: Advertising enabled (device_id: 0x%08X)\n", device_id);
             ble_initialized = true;
             break;
@@ -153,7 +422,19 @@ int ble_advertise_init(uint32_t dev_id) {
     }
     
     device_id = dev_id;
-    reading_id = 0;
+    memset(sensors, 0, sizeof(sensors));
+
+    // Seed every sensor's counter from the persisted sequence floor so IDs
+    // stay monotonic across resets (the gateway dedups on them)
+    uint32_t seq_floor = reading_seq_init();
+    for (int i = 0; i < BLE_ADV_MAX_SENSORS; i++) {
+        sensors[i].reading_id = seq_floor;
+    }
+
+    adv_frames_init();
+    adv_interval_ms = config_get()->adv_fast_ms;
+    adv_burst_left = 0;
+    adv_quiet_cycles = 0;
     
     // Note: cyw43_arch_init() may have already been called by pico_led_init()
     // For Pico W, cyw43_arch_init() can be called multiple times safely
@@ -169,7 +450,11 @@ int ble_advertise_init(uint32_t dev_id) {
     // Initialize BTstack
     l2cap_init();
     sm_init();
-    
+
+    // GATT bulk-transfer service (readings stream + pending count)
+    ble_gatt_init();
+
+
     // Register packet handler
     hci_event_callback_registration.callback = &packet_handler;
     hci_add_event_handler(&hci_event_callback_registration);
@@ -182,27 +467,101 @@ int ble_advertise_init(uint32_t dev_id) {
     return 0;
 }
 
-int ble_advertise_update(sensor_data_t *data) {
+int ble_advertise_update(uint8_t sensor_id, sensor_data_t *data) {
     if (!ble_initialized) {
         return -1;
     }
-    
-    if (data == NULL) {
+
+    if (data == NULL || sensor_id >= BLE_ADV_MAX_SENSORS) {
         return -1;
     }
-    
-    // Increment reading ID for each update
-    reading_id++;
-    
-    // Build new advertisement data
-    build_adv_data(device_id, reading_id, data->temperature, data->pressure, data->humidity);
-    
-    // Update advertisement
-    gap_advertisements_set_data(adv_data_len, adv_data);
-    
-    printf("BLE: Updated advertisement (reading_id: %lu, T: %.2f°C, P: %.2f kPa, H: %.2f%%)\n",
-           reading_id, data->temperature, data->pressure, data->humidity);
-    
+
+    adv_sensor_state_t *s = &sensors[sensor_id];
+
+    // Change detection against this sensor's previous reading; the first
+    // reading always counts as a change so boot advertises fast
+    bool significant = (s->history_count == 0) || reading_changed(&s->history[0], data);
+
+    // Increment this sensor's reading ID for each update and persist the
+    // new high-water mark (scratch mirror + batched flash cell)
+    s->reading_id++;
+    reading_seq_note(s->reading_id);
+
+    // Shift the history ring and append the new reading at the front
+    for (int i = (int)count_of(s->history) - 1; i > 0; i--) {
+        s->history[i] = s->history[i - 1];
+    }
+    s->history[0] = *data;
+    if (s->history_count < count_of(s->history)) {
+        s->history_count++;
+    }
+
+    #ifdef BLE_PAYLOAD_HAS_AGG
+    // Fold the reading into the statistics window; a full window finalizes
+    // into one aggregate frame for this cycle
+    agg_add(&s->agg, data);
+    sensor_agg_t agg;
+    bool window_full = (s->agg.count >= config_get()->agg_window);
+    if (window_full) {
+        agg_finalize(&s->agg, &agg);
+        agg_reset(&s->agg);
+    }
+    #endif
+
+    // Encode into the inactive frame and swap it live; the frame BTstack
+    // may currently be reading stays untouched. With multiple sensors the
+    // advertisement rotates to whichever slot updated last. Every Nth
+    // update the legacy frame carries the TX counters instead — the next
+    // delta frame backfills this cycle's reading.
+    adv_update_count++;
+    uint8_t len;
+    uint32_t t0 = perf_begin();
+    const uint8_t *frame = (adv_update_count % ADV_STATUS_EVERY_N == 0)
+        ? build_status_adv(&len)
+        : build_adv_from_history(sensor_id, &len);
+    perf_end(PERF_ADV_ENCODE, t0);
+    gap_advertisements_set_data(len, (uint8_t *)frame);
+    tx_status.adv_sent++;
+
+    #ifdef ENABLE_LE_EXTENDED_ADVERTISING
+    if (ext_adv_ready) {
+        // On window boundaries the extended set carries the aggregate for
+        // one cycle; every other cycle it carries the deep delta batch.
+        // Gusts and spikes inside the window survive as min/max even when
+        // the instantaneous readings between advertisements are never seen.
+        uint8_t ext_len;
+        const uint8_t *ext_frame;
+        #ifdef BLE_PAYLOAD_HAS_AGG
+        ext_frame = window_full
+            ? build_ext_adv_from_agg(sensor_id, &agg, &ext_len)
+            : build_ext_adv_from_history(sensor_id, &ext_len);
+        if (window_full) {
+            log_event(LOG_EVT_AGG, sensor_id, agg.temp.min, agg.temp.max,
+                      agg.temp.mean,
+                      (int32_t)(((uint32_t)agg.count << 16) | agg.temp.sd));
+        }
+        #else
+        ext_frame = build_ext_adv_from_history(sensor_id, &ext_len);
+        #endif
+        if (gap_extended_advertising_set_adv_data(ext_adv_handle, ext_len,
+                                                  (uint8_t *)ext_frame) != ERROR_CODE_SUCCESS) {
+            tx_status.adv_fail++;
+        } else {
+            tx_status.adv_sent++;
+        }
+    }
+    #elif defined(BLE_PAYLOAD_HAS_AGG)
+    // No extended set: the aggregate has no frame that fits, so the window
+    // statistics are accumulated and dropped (legacy delta frames only)
+    (void)window_full;
+    (void)agg;
+    #endif
+
+    adv_interval_on_reading(significant);
+
+    log_event(LOG_EVT_ADV_UPDATE, sensor_id, (int32_t)s->reading_id,
+              data->temp_centi, data->press_deci, data->hum_centi);
+
     return 0;
 }
 
@@ -222,3 +581,10 @@ void ble_advertise_deinit(void) {
 bool ble_advertise_is_ready(void) {
     return ble_initialized;
 }
+
+uint32_t ble_advertise_reading_id(uint8_t sensor_id) {
+    if (sensor_id >= BLE_ADV_MAX_SENSORS) {
+        return 0;
+    }
+    return sensors[sensor_id].reading_id;
+}
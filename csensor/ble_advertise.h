@@ -1,14 +1,11 @@
 /**
  * BLE Advertising Module for CloudPico
- * 
- * Advertises BME280 sensor data via BLE manufacturer data in the format
- * expected by the gateway:
- * - Magic: 0x01, 0xD0
- * - device_id: uint32 (little-endian)
- * - reading_id: uint32 (little-endian)
- * - temperature: float32 (little-endian)
- * - pressure: float32 (little-endian)
- * - humidity: float32 (little-endian)
+ *
+ * Advertises BME280 sensor data via BLE manufacturer data in the v2
+ * delta-batch format expected by the gateway: the latest reading plus up to
+ * BLE_CODEC_MAX_DELTAS delta-encoded previous readings, so a single received
+ * advertisement backfills readings lost to advertising loss. See ble_codec.h
+ * for the wire layout.
  */
 
 #ifndef BLE_ADVERTISE_H
@@ -24,11 +21,19 @@
 #define BLE_MAGIC_0 0x01
 #define BLE_MAGIC_1 0xD0
 
-// Sensor data structure
+// Sensor slots with independent advertising state. Sensor i advertises
+// under device_id + i with its own reading counter, so the gateway sees
+// each physical sensor as its own station.
+#define BLE_ADV_MAX_SENSORS 4
+
+// Sensor data structure. Fixed-point wire units end-to-end: the Cortex-M0+
+// has no FPU, so the pipeline carries the Bosch integer compensation output
+// rescaled once at readout and never touches soft-float outside the debug
+// printf path.
 typedef struct {
-    float temperature;  // Celsius
-    float pressure;     // kPa
-    float humidity;     // %RH
+    int32_t temp_centi;   // centi-degC (0.01 degC per LSB)
+    int32_t press_deci;   // deci-hPa (0.1 hPa per LSB)
+    int32_t hum_centi;    // centi-%RH (0.01 %RH per LSB)
 } sensor_data_t;
 
 /**
@@ -40,10 +45,17 @@ int ble_advertise_init(uint32_t device_id);
 
 /**
  * Update advertisement with new sensor data
+ * @param sensor_id Sensor slot (0..BLE_ADV_MAX_SENSORS-1)
  * @param data Sensor readings (temperature, pressure, humidity)
  * @return 0 on success, negative on error
  */
-int ble_advertise_update(sensor_data_t *data);
+int ble_advertise_update(uint8_t sensor_id, sensor_data_t *data);
+
+/**
+ * Re-read the runtime configuration's advertising ladder (after a config
+ * write): restarts the adaptive interval from the new fast end.
+ */
+void ble_advertise_on_config(void);
 
 /**
  * Deinitialize BLE advertising
@@ -56,4 +68,11 @@ void ble_advertise_deinit(void);
  */
 bool ble_advertise_is_ready(void);
 
+/**
+ * ID assigned to the most recently advertised reading of a sensor slot
+ * @param sensor_id Sensor slot (0..BLE_ADV_MAX_SENSORS-1)
+ * @return That sensor's reading counter (0 before its first update)
+ */
+uint32_t ble_advertise_reading_id(uint8_t sensor_id);
+
 #endif // BLE_ADVERTISE_H
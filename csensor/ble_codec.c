@@ -0,0 +1,285 @@
+/**
+ * BLE Manufacturer-Data Codec for CloudPico
+ *
+ * v2 delta-batch encoder/decoder. See ble_codec.h for the wire layout.
+ *
+ * Readings arrive already in wire units (centi-degC, deci-hPa, centi-%RH —
+ * see sensor_data_t) and deltas are computed in those units, so encoding is
+ * pure integer arithmetic and decode reproduces the history exactly — no
+ * soft-float calls and no cumulative rounding drift across the delta chain.
+ */
+
+#include <string.h>
+#include "ble_codec.h"
+
+// Delta wire units: 0.1 degC, 0.1 hPa, 0.25 %RH per LSB
+#define DELTA_TEMP_CENTI_PER_LSB 10
+#define DELTA_PRESS_DECI_PER_LSB 1
+#define DELTA_HUM_CENTI_PER_LSB 25
+
+static int32_t clamp_i32(int32_t v, int32_t lo, int32_t hi) {
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return v;
+}
+
+// Encode one quantized difference as an int8 delta, or
+// BLE_CODEC_DELTA_INVALID if it does not fit the delta range.
+static int8_t encode_delta_field(int32_t diff, int32_t units_per_lsb) {
+    // Deltas must reconstruct exactly, so reject anything that doesn't
+    // land on a representable step
+    if (diff % units_per_lsb != 0) {
+        return BLE_CODEC_DELTA_INVALID;
+    }
+    int32_t steps = diff / units_per_lsb;
+    if (steps < -127 || steps > 127) {
+        return BLE_CODEC_DELTA_INVALID;
+    }
+    return (int8_t)steps;
+}
+
+static void put_u32_le(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)((v >> 24) & 0xFF);
+}
+
+static uint32_t get_u32_le(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u16_le(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+static uint16_t get_u16_le(const uint8_t *p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+uint8_t ble_codec_encode_delta(uint8_t *buf,
+                               uint32_t device_id,
+                               uint32_t reading_id,
+                               const sensor_data_t *history,
+                               uint8_t history_count)
+{
+    uint8_t *p = buf;
+
+    uint8_t deltas = 0;
+    if (history_count > 1) {
+        deltas = history_count - 1;
+        if (deltas > BLE_CODEC_MAX_DELTAS_EXT) {
+            deltas = BLE_CODEC_MAX_DELTAS_EXT;
+        }
+    }
+
+    // Header
+    *p++ = BLE_MAGIC_0;
+    *p++ = BLE_MAGIC_1;
+    *p++ = BLE_FORMAT_DELTA_V2;
+    put_u32_le(p, device_id);
+    p += 4;
+    put_u32_le(p, reading_id);
+    p += 4;
+    uint8_t *count_slot = p++;  // patched below: deltas may shrink on overflow
+
+    // Latest reading, already in wire units
+    sensor_data_t prev = history[0];
+    put_u16_le(p, (uint16_t)(int16_t)clamp_i32(prev.temp_centi, INT16_MIN, INT16_MAX));
+    p += 2;
+    put_u16_le(p, (uint16_t)clamp_i32(prev.press_deci, 0, UINT16_MAX));
+    p += 2;
+    put_u16_le(p, (uint16_t)clamp_i32(prev.hum_centi, 0, UINT16_MAX));
+    p += 2;
+
+    // Deltas, newest-to-oldest; stop at the first unrepresentable one since
+    // the decoder can't skip past it anyway
+    uint8_t encoded = 0;
+    for (uint8_t i = 0; i < deltas; i++) {
+        sensor_data_t cur = history[i + 1];
+
+        int8_t d_temp = encode_delta_field(cur.temp_centi - prev.temp_centi, DELTA_TEMP_CENTI_PER_LSB);
+        int8_t d_press = encode_delta_field(cur.press_deci - prev.press_deci, DELTA_PRESS_DECI_PER_LSB);
+        int8_t d_hum = encode_delta_field(cur.hum_centi - prev.hum_centi, DELTA_HUM_CENTI_PER_LSB);
+        if (d_temp == BLE_CODEC_DELTA_INVALID ||
+            d_press == BLE_CODEC_DELTA_INVALID ||
+            d_hum == BLE_CODEC_DELTA_INVALID) {
+            break;
+        }
+
+        *p++ = (uint8_t)d_temp;
+        *p++ = (uint8_t)d_press;
+        *p++ = (uint8_t)d_hum;
+        encoded++;
+        prev = cur;
+    }
+
+    *count_slot = encoded;
+    return (uint8_t)(p - buf);
+}
+
+bool ble_codec_decode_delta(const uint8_t *buf,
+                            uint8_t len,
+                            uint32_t *device_id,
+                            uint32_t *reading_id,
+                            sensor_data_t *out,
+                            uint8_t *out_count)
+{
+    if (len < BLE_CODEC_V2_BASE_LEN) {
+        return false;
+    }
+    if (buf[0] != BLE_MAGIC_0 || buf[1] != BLE_MAGIC_1 || buf[2] != BLE_FORMAT_DELTA_V2) {
+        return false;
+    }
+
+    *device_id = get_u32_le(&buf[3]);
+    *reading_id = get_u32_le(&buf[7]);
+
+    uint8_t deltas = buf[11];
+    if (deltas > BLE_CODEC_MAX_DELTAS_EXT ||
+        len < BLE_CODEC_V2_BASE_LEN + deltas * BLE_CODEC_V2_DELTA_LEN) {
+        return false;
+    }
+
+    sensor_data_t q;
+    q.temp_centi = (int16_t)get_u16_le(&buf[12]);
+    q.press_deci = get_u16_le(&buf[14]);
+    q.hum_centi = get_u16_le(&buf[16]);
+    out[0] = q;
+
+    uint8_t count = 1;
+    const uint8_t *d = &buf[BLE_CODEC_V2_BASE_LEN];
+    for (uint8_t i = 0; i < deltas; i++) {
+        q.temp_centi += (int8_t)d[0] * DELTA_TEMP_CENTI_PER_LSB;
+        q.press_deci += (int8_t)d[1] * DELTA_PRESS_DECI_PER_LSB;
+        q.hum_centi += (int8_t)d[2] * DELTA_HUM_CENTI_PER_LSB;
+        out[count] = q;
+        count++;
+        d += BLE_CODEC_V2_DELTA_LEN;
+    }
+
+    *out_count = count;
+    return true;
+}
+
+#ifdef BLE_PAYLOAD_HAS_AGG
+
+// Store one channel's statistics as four 16-bit fields. Signedness follows
+// the v2 base fields: temperature is signed, pressure/humidity unsigned.
+static uint8_t *put_agg_channel(uint8_t *p, const agg_channel_t *ch, bool is_signed) {
+    int32_t lo = is_signed ? INT16_MIN : 0;
+    int32_t hi = is_signed ? INT16_MAX : UINT16_MAX;
+    put_u16_le(p, (uint16_t)clamp_i32(ch->mean, lo, hi));
+    put_u16_le(p + 2, (uint16_t)clamp_i32(ch->min, lo, hi));
+    put_u16_le(p + 4, (uint16_t)clamp_i32(ch->max, lo, hi));
+    put_u16_le(p + 6, ch->sd);
+    return p + 8;
+}
+
+static const uint8_t *get_agg_channel(const uint8_t *p, agg_channel_t *ch, bool is_signed) {
+    if (is_signed) {
+        ch->mean = (int16_t)get_u16_le(p);
+        ch->min = (int16_t)get_u16_le(p + 2);
+        ch->max = (int16_t)get_u16_le(p + 4);
+    } else {
+        ch->mean = get_u16_le(p);
+        ch->min = get_u16_le(p + 2);
+        ch->max = get_u16_le(p + 4);
+    }
+    ch->sd = get_u16_le(p + 6);
+    return p + 8;
+}
+
+uint8_t ble_codec_encode_agg(uint8_t *buf,
+                             uint32_t device_id,
+                             uint32_t reading_id,
+                             const sensor_agg_t *agg)
+{
+    uint8_t *p = buf;
+
+    *p++ = BLE_MAGIC_0;
+    *p++ = BLE_MAGIC_1;
+    *p++ = BLE_FORMAT_AGG_V3;
+    put_u32_le(p, device_id);
+    p += 4;
+    put_u32_le(p, reading_id);
+    p += 4;
+    *p++ = agg->count;
+
+    p = put_agg_channel(p, &agg->temp, true);
+    p = put_agg_channel(p, &agg->press, false);
+    p = put_agg_channel(p, &agg->hum, false);
+
+    return (uint8_t)(p - buf);
+}
+
+bool ble_codec_decode_agg(const uint8_t *buf,
+                          uint8_t len,
+                          uint32_t *device_id,
+                          uint32_t *reading_id,
+                          sensor_agg_t *out)
+{
+    if (len < BLE_CODEC_V3_LEN) {
+        return false;
+    }
+    if (buf[0] != BLE_MAGIC_0 || buf[1] != BLE_MAGIC_1 || buf[2] != BLE_FORMAT_AGG_V3) {
+        return false;
+    }
+
+    *device_id = get_u32_le(&buf[3]);
+    *reading_id = get_u32_le(&buf[7]);
+    out->count = buf[11];
+
+    const uint8_t *p = &buf[12];
+    p = get_agg_channel(p, &out->temp, true);
+    p = get_agg_channel(p, &out->press, false);
+    (void)get_agg_channel(p, &out->hum, false);
+
+    return true;
+}
+
+#endif // BLE_PAYLOAD_HAS_AGG
+
+uint8_t ble_codec_encode_status(uint8_t *buf,
+                                uint32_t device_id,
+                                const ble_status_t *status)
+{
+    uint8_t *p = buf;
+
+    *p++ = BLE_MAGIC_0;
+    *p++ = BLE_MAGIC_1;
+    *p++ = BLE_FORMAT_STATUS_V4;
+    put_u32_le(p, device_id);
+    p += 4;
+    put_u32_le(p, status->uptime_s);
+    p += 4;
+    put_u32_le(p, status->adv_sent);
+    p += 4;
+    put_u16_le(p, status->adv_fail);
+    p += 2;
+    put_u16_le(p, status->stack_restarts);
+    p += 2;
+
+    return (uint8_t)(p - buf);
+}
+
+bool ble_codec_decode_status(const uint8_t *buf,
+                             uint8_t len,
+                             uint32_t *device_id,
+                             ble_status_t *out)
+{
+    if (len < BLE_CODEC_V4_LEN) {
+        return false;
+    }
+    if (buf[0] != BLE_MAGIC_0 || buf[1] != BLE_MAGIC_1 || buf[2] != BLE_FORMAT_STATUS_V4) {
+        return false;
+    }
+
+    *device_id = get_u32_le(&buf[3]);
+    out->uptime_s = get_u32_le(&buf[7]);
+    out->adv_sent = get_u32_le(&buf[11]);
+    out->adv_fail = get_u16_le(&buf[15]);
+    out->stack_restarts = get_u16_le(&buf[17]);
+    return true;
+}
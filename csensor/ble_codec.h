@@ -0,0 +1,164 @@
+/**
+ * BLE Manufacturer-Data Codec for CloudPico
+ *
+ * Encodes sensor readings into the manufacturer-data payload carried by
+ * advertisements. Two formats share the BLE_MAGIC_0/1 header:
+ *
+ * v1 (legacy, no version byte):
+ *   magic (2) + device_id u32 + reading_id u32 + temp f32 + pressure f32 +
+ *   humidity f32 = 22 bytes, one reading per packet.
+ *
+ * v2 (delta batch, version byte 0x02 after the magic):
+ *   magic (2) + version (1) + device_id u32 + reading_id u32 + count (1) +
+ *   latest reading quantized (temp i16 centi-degC, pressure u16 deci-hPa,
+ *   humidity u16 centi-%RH) + count * 3-byte deltas = 18..24 bytes.
+ *   Each delta reconstructs the next-older reading (reading_id - 1 - i) from
+ *   the one before it, so a single received advertisement backfills up to
+ *   BLE_CODEC_MAX_DELTAS readings lost to advertising loss.
+ *
+ * This module is deliberately radio-free (no BTstack/pico includes) so it
+ * can be compiled and benchmarked on the host.
+ */
+
+#ifndef _BLE_CODEC_H
+#define _BLE_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_advertise.h"
+#ifdef BLE_PAYLOAD_HAS_AGG
+#include "aggregate.h"
+#endif
+
+// Payload format version bytes (byte 2, after BLE_MAGIC_0/1)
+#define BLE_FORMAT_DELTA_V2 0x02
+#define BLE_FORMAT_AGG_V3 0x03
+#define BLE_FORMAT_STATUS_V4 0x04
+
+// Number of delta-encoded previous readings in a v2 frame carried by a
+// legacy advertisement. Bounded by the 31-byte limit: 7 bytes AD overhead +
+// 18-byte v2 base leaves room for exactly two 3-byte deltas.
+#define BLE_CODEC_MAX_DELTAS 2
+
+// Deltas per frame on the extended advertising set (255-byte ADV_EXT_IND
+// chains). The wire format is identical — the count byte already covers
+// this range — old gateways just never see frames this large.
+#define BLE_CODEC_MAX_DELTAS_EXT 16
+
+// v2 frame sizes
+#define BLE_CODEC_V2_BASE_LEN 18
+#define BLE_CODEC_V2_DELTA_LEN 3
+#define BLE_CODEC_V2_MAX_LEN (BLE_CODEC_V2_BASE_LEN + BLE_CODEC_MAX_DELTAS * BLE_CODEC_V2_DELTA_LEN)
+#define BLE_CODEC_V2_EXT_MAX_LEN (BLE_CODEC_V2_BASE_LEN + BLE_CODEC_MAX_DELTAS_EXT * BLE_CODEC_V2_DELTA_LEN)
+
+// v3 aggregate frame: magic (2) + version (1) + device_id u32 +
+// reading_id u32 + window count (1) + per channel mean/min/max/sd as
+// 16-bit wire-unit fields (temp signed, pressure/humidity unsigned).
+// 36 bytes: extended-advertising only.
+#define BLE_CODEC_V3_LEN 36
+
+// v4 status frame: magic (2) + version (1) + device_id u32 + uptime u32 (s)
+// + advertisements sent u32 + set-data failures u16 + stack restarts u16.
+// 19 bytes; fits the legacy set, interleaved every Nth advertisement.
+#define BLE_CODEC_V4_LEN 19
+
+// Delta value meaning "older reading not representable"; the decoder stops
+// backfilling at the first occurrence.
+#define BLE_CODEC_DELTA_INVALID (-128)
+
+/**
+ * Encode a v2 delta-batch payload.
+ *
+ * @param buf Output buffer, at least BLE_CODEC_V2_BASE_LEN plus
+ *            3 bytes per requested delta (BLE_CODEC_V2_EXT_MAX_LEN covers
+ *            any history)
+ * @param device_id Device identifier
+ * @param reading_id ID of the latest reading (history[0])
+ * @param history Readings, newest first; history[0] is required
+ * @param history_count Number of valid entries in history (>= 1)
+ * @return Encoded payload length in bytes
+ */
+uint8_t ble_codec_encode_delta(uint8_t *buf,
+                               uint32_t device_id,
+                               uint32_t reading_id,
+                               const sensor_data_t *history,
+                               uint8_t history_count);
+
+/**
+ * Decode a v2 delta-batch payload (used by the host-side harness and tests).
+ *
+ * @param buf Payload bytes (starting at the magic)
+ * @param len Payload length
+ * @param device_id Decoded device identifier (output)
+ * @param reading_id ID of the latest decoded reading (output)
+ * @param out Decoded readings, newest first; room for
+ *            1 + BLE_CODEC_MAX_DELTAS_EXT
+ * @param out_count Number of readings decoded (output)
+ * @return true if the payload was a valid v2 frame
+ */
+bool ble_codec_decode_delta(const uint8_t *buf,
+                            uint8_t len,
+                            uint32_t *device_id,
+                            uint32_t *reading_id,
+                            sensor_data_t *out,
+                            uint8_t *out_count);
+
+// The v3 aggregate encoder exists only in delta_agg builds
+// (PAYLOAD_FORMAT in CMakeLists.txt); delta-only nodes carry one encoder
+#ifdef BLE_PAYLOAD_HAS_AGG
+
+/**
+ * Encode a v3 aggregate payload (window statistics from aggregate.h).
+ *
+ * @param buf Output buffer, at least BLE_CODEC_V3_LEN bytes
+ * @param device_id Device identifier
+ * @param reading_id ID of the newest reading folded into the window
+ * @param agg Finalized window statistics
+ * @return Encoded payload length (BLE_CODEC_V3_LEN)
+ */
+uint8_t ble_codec_encode_agg(uint8_t *buf,
+                             uint32_t device_id,
+                             uint32_t reading_id,
+                             const sensor_agg_t *agg);
+
+/**
+ * Decode a v3 aggregate payload (host-side harness and tests).
+ * @return true if the payload was a valid v3 frame
+ */
+bool ble_codec_decode_agg(const uint8_t *buf,
+                          uint8_t len,
+                          uint32_t *device_id,
+                          uint32_t *reading_id,
+                          sensor_agg_t *out);
+
+#endif // BLE_PAYLOAD_HAS_AGG
+
+// Transmit-side counters carried by the v4 status frame. With per-device
+// TX counts the fleet can separate air loss (sent but never received)
+// from device stalls (never sent).
+typedef struct {
+    uint32_t uptime_s;         // seconds since boot
+    uint32_t adv_sent;         // advertisement data updates pushed
+    uint16_t adv_fail;         // controller rejections of advertising data
+    uint16_t stack_restarts;   // BTstack returns to HCI working state after the first
+} ble_status_t;
+
+/**
+ * Encode a v4 status payload.
+ * @param buf Output buffer, at least BLE_CODEC_V4_LEN bytes
+ * @return Encoded payload length (BLE_CODEC_V4_LEN)
+ */
+uint8_t ble_codec_encode_status(uint8_t *buf,
+                                uint32_t device_id,
+                                const ble_status_t *status);
+
+/**
+ * Decode a v4 status payload (host-side harness and tests).
+ * @return true if the payload was a valid v4 frame
+ */
+bool ble_codec_decode_status(const uint8_t *buf,
+                             uint8_t len,
+                             uint32_t *device_id,
+                             ble_status_t *out);
+
+#endif /* _BLE_CODEC_H */
@@ -0,0 +1,192 @@
+/**
+ * GATT Bulk-Transfer Service for CloudPico
+ *
+ * See ble_gatt.h and telemetry.gatt for the profile. The drain loop is
+ * flow-controlled by BTstack: each ATT_EVENT_CAN_SEND_NOW sends one record
+ * and requests the next slot while the flash log has pending records, so
+ * notifications fill every connection event without overrunning the
+ * controller's buffers.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "btstack.h"
+#include "pico/stdlib.h"
+#include "telemetry.h"
+#include "ble_gatt.h"
+#include "config.h"
+#include "flash_store.h"
+
+// Notified record: flash_record_t minus the magic, little-endian
+#define GATT_RECORD_LEN 15
+
+static hci_con_handle_t client_handle = HCI_CON_HANDLE_INVALID;
+static bool notifications_enabled = false;
+
+static btstack_packet_callback_registration_t gatt_hci_callback_registration;
+
+/**
+ * Serialize one record for the readings characteristic
+ */
+static void pack_record(uint8_t *buf, uint8_t sensor_id, uint32_t reading_id,
+                        uint32_t uptime_s, int16_t temp_centi,
+                        uint16_t press_deci, uint16_t hum_centi) {
+    little_endian_store_32(buf, 0, reading_id);
+    little_endian_store_32(buf, 4, uptime_s);
+    little_endian_store_16(buf, 8, (uint16_t)temp_centi);
+    little_endian_store_16(buf, 10, press_deci);
+    little_endian_store_16(buf, 12, hum_centi);
+    buf[14] = sensor_id;
+}
+
+/**
+ * Send the record at the drain cursor, ack it, and request another slot if
+ * more are pending
+ */
+static void send_next_record(void) {
+    flash_record_t rec;
+    if (!flash_store_drain_peek(&rec)) {
+        return;
+    }
+
+    uint8_t buf[GATT_RECORD_LEN];
+    pack_record(buf, rec.sensor_id, rec.reading_id, rec.uptime_s,
+                rec.temp_centi, rec.press_deci, rec.hum_centi);
+
+    int rc = att_server_notify(client_handle,
+                               ATT_CHARACTERISTIC_C10D0002_5B1E_4D3C_9A8F_2E45C3B0A001_01_VALUE_HANDLE,
+                               buf, sizeof(buf));
+    if (rc != 0) {
+        // Buffer pressure: retry on the next can-send-now slot
+        att_server_request_can_send_now_event(client_handle);
+        return;
+    }
+
+    flash_store_drain_ack();
+    if (flash_store_pending() > 0) {
+        att_server_request_can_send_now_event(client_handle);
+    }
+}
+
+/**
+ * ATT server packet handler: drives the drain loop
+ */
+static void att_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size) {
+    UNUSED(channel);
+    UNUSED(size);
+
+    if (packet_type != HCI_EVENT_PACKET) return;
+
+    switch (hci_event_packet_get_type(packet)) {
+        case ATT_EVENT_CAN_SEND_NOW:
+            if (notifications_enabled) {
+                send_next_record();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * HCI packet handler: tears down the streaming state on disconnect
+ */
+static void gatt_hci_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size) {
+    UNUSED(channel);
+    UNUSED(size);
+
+    if (packet_type != HCI_EVENT_PACKET) return;
+
+    if (hci_event_packet_get_type(packet) == HCI_EVENT_DISCONNECTION_COMPLETE) {
+        notifications_enabled = false;
+        client_handle = HCI_CON_HANDLE_INVALID;
+        printf("GATT: client disconnected, %u records still pending\n",
+               (unsigned)flash_store_pending());
+    }
+}
+
+/**
+ * ATT read callback: serves the pending-count characteristic
+ */
+static uint16_t att_read_callback(hci_con_handle_t con_handle, uint16_t att_handle,
+                                  uint16_t offset, uint8_t *buffer, uint16_t buffer_size) {
+    UNUSED(con_handle);
+
+    if (att_handle == ATT_CHARACTERISTIC_C10D0003_5B1E_4D3C_9A8F_2E45C3B0A001_01_VALUE_HANDLE) {
+        uint8_t value[4];
+        little_endian_store_32(value, 0, flash_store_pending());
+        return att_read_callback_handle_blob(value, sizeof(value), offset, buffer, buffer_size);
+    }
+    if (att_handle == ATT_CHARACTERISTIC_C10D0004_5B1E_4D3C_9A8F_2E45C3B0A001_01_VALUE_HANDLE) {
+        uint8_t value[CONFIG_BLOB_LEN];
+        config_pack(value);
+        return att_read_callback_handle_blob(value, sizeof(value), offset, buffer, buffer_size);
+    }
+    return 0;
+}
+
+/**
+ * ATT write callback: handles subscription to the readings stream
+ */
+static int att_write_callback(hci_con_handle_t con_handle, uint16_t att_handle,
+                              uint16_t transaction_mode, uint16_t offset,
+                              uint8_t *buffer, uint16_t buffer_size) {
+    UNUSED(transaction_mode);
+    UNUSED(offset);
+
+    if (att_handle == ATT_CHARACTERISTIC_C10D0002_5B1E_4D3C_9A8F_2E45C3B0A001_01_CLIENT_CONFIGURATION_HANDLE) {
+        notifications_enabled =
+            little_endian_read_16(buffer, 0) == GATT_CLIENT_CHARACTERISTICS_CONFIGURATION_NOTIFICATION;
+        client_handle = con_handle;
+        if (notifications_enabled) {
+            printf("GATT: client subscribed, draining %u pending records\n",
+                   (unsigned)flash_store_pending());
+            // Push staged records out so the drain sees everything
+            flash_store_flush();
+            if (flash_store_pending() > 0) {
+                att_server_request_can_send_now_event(client_handle);
+            }
+        }
+        return 0;
+    }
+    if (att_handle == ATT_CHARACTERISTIC_C10D0004_5B1E_4D3C_9A8F_2E45C3B0A001_01_VALUE_HANDLE) {
+        // Validate and apply the whole blob; persistence and the live
+        // update happen inside config_apply_blob
+        if (config_apply_blob(buffer, buffer_size) != 0) {
+            return ATT_ERROR_VALUE_NOT_ALLOWED;
+        }
+        // Advertising re-reads its ladder endpoints immediately; the poll
+        // interval is re-read each sampling cycle, the profile on reboot
+        ble_advertise_on_config();
+        return 0;
+    }
+    UNUSED(buffer_size);
+    return 0;
+}
+
+void ble_gatt_init(void) {
+    att_server_init(profile_data, att_read_callback, att_write_callback);
+    att_server_register_packet_handler(att_packet_handler);
+
+    gatt_hci_callback_registration.callback = &gatt_hci_packet_handler;
+    hci_add_event_handler(&gatt_hci_callback_registration);
+
+    printf("GATT: telemetry service registered\n");
+}
+
+void ble_gatt_on_reading(uint8_t sensor_id, uint32_t reading_id, const sensor_data_t *data) {
+    if (!notifications_enabled) {
+        return;
+    }
+
+    // Live readings bypass the flash staging latency; the drain loop keeps
+    // its own cursor, so a duplicate on the air is deduplicated by reading_id
+    // on the gateway side
+    uint8_t buf[GATT_RECORD_LEN];
+    pack_record(buf, sensor_id, reading_id, to_ms_since_boot(get_absolute_time()) / 1000,
+                (int16_t)data->temp_centi, (uint16_t)data->press_deci,
+                (uint16_t)data->hum_centi);
+    att_server_notify(client_handle,
+                      ATT_CHARACTERISTIC_C10D0002_5B1E_4D3C_9A8F_2E45C3B0A001_01_VALUE_HANDLE,
+                      buf, sizeof(buf));
+}
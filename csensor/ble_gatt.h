@@ -0,0 +1,33 @@
+/**
+ * GATT Bulk-Transfer Service for CloudPico
+ *
+ * Connectable alternative to the advertising channel: the gateway connects,
+ * subscribes to the readings characteristic, and the firmware streams the
+ * persistent flash log as notifications — one 15-byte record per
+ * notification, many per connection event — acknowledging records against
+ * the flash store's drain cursor as they are handed to the controller.
+ */
+
+#ifndef _BLE_GATT_H
+#define _BLE_GATT_H
+
+#include <stdint.h>
+#include "ble_advertise.h"
+
+/**
+ * Initialize the ATT server with the CloudPico telemetry profile.
+ * Must be called after l2cap_init()/sm_init() and before HCI power-on;
+ * ble_advertise_init() does this.
+ */
+void ble_gatt_init(void);
+
+/**
+ * Push a freshly-taken reading to a subscribed client immediately, without
+ * waiting for it to reach flash. No-op when nobody is subscribed.
+ * @param sensor_id Sensor bus slot that took the reading
+ * @param reading_id That sensor's monotonic reading counter
+ * @param data Compensated reading
+ */
+void ble_gatt_on_reading(uint8_t sensor_id, uint32_t reading_id, const sensor_data_t *data);
+
+#endif /* _BLE_GATT_H */
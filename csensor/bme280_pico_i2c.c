@@ -1,9 +1,15 @@
 /**
  * BME280 I2C Adapter for Raspberry Pi Pico
- * 
+ *
  * This file provides the I2C interface functions required by the Bosch Sensortec
  * BME280 Sensor API to work with Raspberry Pi Pico's I2C hardware.
- * 
+ *
+ * Transfers are DMA-driven: one channel feeds 16-bit command words into the
+ * I2C block's IC_DATA_CMD register, a second drains the RX FIFO into the
+ * caller's buffer. The submitting core keeps running the configured idle hook
+ * (normally the cyw43 async context poll) until the completion interrupt
+ * fires, so sensor I/O no longer stalls BLE event servicing.
+ *
  * PIN CONNECTIONS (Raspberry Pi Pico):
  * ====================================
  * Pico Pin  | GPIO  | Function | BME280 Pin
@@ -12,7 +18,7 @@
  * Pin 22    | GP17  | SCL      | SCL
  * Pin 36    | 3V3   | Power    | VCC/VIN
  * Pin 38    | GND   | Ground   | GND
- * 
+ *
  * BME280 I2C Address:
  * - 0x76 if SDO pin is connected to GND
  * - 0x77 if SDO pin is connected to VCC
@@ -20,8 +26,12 @@
 
 #include <stdio.h>
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "pico/stdlib.h"
 #include "bme280.h"
+#include "bme280_pico_i2c.h"
+#include "perf.h"
 
 // BME280 I2C address (can be 0x76 or 0x77 depending on SDO pin)
 #define BME280_ADDR _u(0x76)
@@ -31,21 +41,160 @@
 #define I2C_SDA_PIN 16   // GP16 (Pin 21) - SDA (Serial Data)
 #define I2C_SCL_PIN 17   // GP17 (Pin 22) - SCL (Serial Clock)
 
+// Give up on a transfer if the completion interrupt hasn't fired after this
+// long. Worst case on the bus is the 28-entry calibration burst at 100 kHz
+// (~3 ms), so 100 ms only trips on a wedged bus.
+#define I2C_DMA_TIMEOUT_MS 100
+
+// IC_DATA_CMD control bits (see RP2040 datasheet, I2C chapter)
+#define I2C_CMD_READ    (1u << 8)   // issue a read for this entry
+#define I2C_CMD_STOP    (1u << 9)   // generate STOP after this entry
+#define I2C_CMD_RESTART (1u << 10)  // generate RESTART before this entry
+
+// The DMA IRQ handler needs to find the context that owns the completing
+// channel. The bus manager registers one context per attached sensor.
+#define MAX_I2C_CONTEXTS 4
+static struct bme280_pico_i2c_context *irq_ctxs[MAX_I2C_CONTEXTS];
+static uint8_t irq_ctx_count = 0;
+
+/**
+ * @brief DMA completion handler
+ *
+ * Fires on DMA_IRQ_0 when the final channel of a transfer finishes (RX for
+ * reads, TX for writes). Clears the interrupt and marks the owning context
+ * idle.
+ */
+static void bme280_dma_irq_handler(void) {
+    for (uint8_t i = 0; i < irq_ctx_count; i++) {
+        struct bme280_pico_i2c_context *ctx = irq_ctxs[i];
+        if (dma_channel_get_irq0_status(ctx->dma_rx_chan)) {
+            dma_channel_acknowledge_irq0(ctx->dma_rx_chan);
+            ctx->dma_busy = false;
+        }
+        if (dma_channel_get_irq0_status(ctx->dma_tx_chan)) {
+            dma_channel_acknowledge_irq0(ctx->dma_tx_chan);
+            ctx->dma_busy = false;
+        }
+    }
+}
+
+/**
+ * @brief Wait for the in-flight DMA transfer to complete
+ *
+ * Runs the idle hook (if set) while waiting, so the caller's other subsystems
+ * keep being serviced. Returns BME280_INTF_RET_SUCCESS on completion,
+ * BME280_E_COMM_FAIL on timeout or bus abort.
+ */
+static BME280_INTF_RET_TYPE bme280_dma_wait(struct bme280_pico_i2c_context *ctx) {
+    absolute_time_t deadline = make_timeout_time_ms(I2C_DMA_TIMEOUT_MS);
+
+    while (ctx->dma_busy) {
+        if (ctx->idle_hook != NULL) {
+            ctx->idle_hook();
+        } else {
+            tight_loop_contents();
+        }
+        if (time_reached(deadline)) {
+            // Bus is wedged or the device NACKed: kill the channels and
+            // reset the I2C block so the next transaction starts clean.
+            dma_channel_abort(ctx->dma_tx_chan);
+            dma_channel_abort(ctx->dma_rx_chan);
+            ctx->dma_busy = false;
+            i2c_hw_t *hw = i2c_get_hw(ctx->i2c);
+            hw->enable = 0;
+            hw->enable = 1;
+            return BME280_E_COMM_FAIL;
+        }
+    }
+
+    // For writes the TX channel completes as soon as the last command word
+    // lands in the I2C TX FIFO — the bus transaction is still draining, and
+    // a NACK may not have latched yet. Wait for the FIFO to empty and the
+    // master to go idle before sampling the abort status (an abort flushes
+    // the FIFO, so this also converges on failure).
+    i2c_hw_t *hw = i2c_get_hw(ctx->i2c);
+    if (ctx->tx_only) {
+        while (!(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+               (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) {
+            if (time_reached(deadline)) {
+                hw->enable = 0;
+                hw->enable = 1;
+                return BME280_E_COMM_FAIL;
+            }
+            tight_loop_contents();
+        }
+    }
+
+    // A slave NACK aborts the transfer without stopping the DMA cleanly;
+    // check and clear the abort source so it doesn't poison later transfers.
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        (void)hw->clr_tx_abrt;
+        return BME280_E_COMM_FAIL;
+    }
+
+    return BME280_INTF_RET_SUCCESS;
+}
+
 /**
- * Structure to hold I2C interface context
+ * @brief Submit the prepared command buffer to the DMA engine
+ *
+ * TX channel streams ctx->cmd_buf (16-bit entries, control bits included)
+ * into IC_DATA_CMD; for reads, the RX channel concurrently drains the RX
+ * FIFO into reg_data. Completion is signalled by the interrupt on whichever
+ * channel finishes the transaction.
  */
-struct bme280_pico_i2c_context {
-    i2c_inst_t *i2c;
-    uint8_t addr;
-};
+static void bme280_dma_submit(struct bme280_pico_i2c_context *ctx,
+                              const uint16_t *cmd_buf,
+                              uint cmd_count,
+                              uint8_t *rx_buf,
+                              uint rx_count) {
+    i2c_hw_t *hw = i2c_get_hw(ctx->i2c);
+
+    // Several contexts (sensors at different addresses) can share one I2C
+    // block, so the target address is programmed per transaction
+    if (hw->tar != ctx->addr) {
+        hw->enable = 0;
+        hw->tar = ctx->addr;
+        hw->enable = 1;
+    }
+
+    ctx->dma_busy = true;
+    ctx->tx_only = (rx_count == 0);
+
+    if (rx_count > 0) {
+        dma_channel_config rx_cfg = dma_channel_get_default_config(ctx->dma_rx_chan);
+        channel_config_set_transfer_data_size(&rx_cfg, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx_cfg, false);
+        channel_config_set_write_increment(&rx_cfg, true);
+        channel_config_set_dreq(&rx_cfg, i2c_get_dreq(ctx->i2c, false));
+        // Reads complete when the last byte lands in rx_buf
+        dma_channel_set_irq0_enabled(ctx->dma_rx_chan, true);
+        dma_channel_set_irq0_enabled(ctx->dma_tx_chan, false);
+        dma_channel_configure(ctx->dma_rx_chan, &rx_cfg,
+                              rx_buf, &hw->data_cmd, rx_count, true);
+    } else {
+        // Writes complete when the last command word has been consumed
+        dma_channel_set_irq0_enabled(ctx->dma_rx_chan, false);
+        dma_channel_set_irq0_enabled(ctx->dma_tx_chan, true);
+    }
+
+    dma_channel_config tx_cfg = dma_channel_get_default_config(ctx->dma_tx_chan);
+    channel_config_set_transfer_data_size(&tx_cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&tx_cfg, true);
+    channel_config_set_write_increment(&tx_cfg, false);
+    channel_config_set_dreq(&tx_cfg, i2c_get_dreq(ctx->i2c, true));
+    dma_channel_configure(ctx->dma_tx_chan, &tx_cfg,
+                          &hw->data_cmd, cmd_buf, cmd_count, true);
+}
 
 /**
  * @brief I2C read function for Bosch BME280 API
- * 
+ *
  * This function is called by the Bosch API to read data from the BME280 sensor
- * via I2C. It adapts the Bosch API's function signature to Raspberry Pi Pico's
- * I2C functions.
- * 
+ * via I2C. The register-address write and the burst read are issued as one
+ * DMA-driven transaction (RESTART between phases, STOP after the last byte);
+ * the CPU services the idle hook until the completion interrupt fires.
+ *
  * @param reg_addr Register address to read from
  * @param reg_data Buffer to store read data
  * @param len Number of bytes to read
@@ -55,32 +204,60 @@ struct bme280_pico_i2c_context {
 BME280_INTF_RET_TYPE bme280_pico_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
 {
     struct bme280_pico_i2c_context *ctx = (struct bme280_pico_i2c_context *)intf_ptr;
-    
+
     if (ctx == NULL || reg_data == NULL) {
         return BME280_E_NULL_PTR;
     }
-    
-    // Write register address, then read data
-    int ret = i2c_write_blocking(ctx->i2c, ctx->addr, &reg_addr, 1, true);  // true = keep master control
-    if (ret != 1) {
-        return BME280_E_COMM_FAIL;
+
+    // 1 address entry + len read entries must fit the command buffer
+    if (len + 1 > count_of(ctx->cmd_buf)) {
+        return BME280_E_INVALID_LEN;
     }
-    
-    ret = i2c_read_blocking(ctx->i2c, ctx->addr, reg_data, len, false);  // false = finished with bus
-    if (ret != (int)len) {
-        return BME280_E_COMM_FAIL;
+
+    // Phase 1: write the register address; phase 2: clock in len bytes.
+    ctx->cmd_buf[0] = reg_addr;
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t cmd = I2C_CMD_READ;
+        if (i == 0) {
+            cmd |= I2C_CMD_RESTART;
+        }
+        if (i == len - 1) {
+            cmd |= I2C_CMD_STOP;
+        }
+        ctx->cmd_buf[i + 1] = cmd;
     }
-    
-    return BME280_INTF_RET_SUCCESS;
+
+    uint32_t t0 = perf_begin();
+    bme280_dma_submit(ctx, ctx->cmd_buf, len + 1, reg_data, len);
+    BME280_INTF_RET_TYPE rslt = bme280_dma_wait(ctx);
+    perf_end(PERF_I2C_XFER, t0);
+    return rslt;
+}
+
+/**
+ * @brief Burst-read the raw data registers into a caller frame
+ *
+ * Submits the pre-armed 0xF7..0xFE command sequence directly; see the
+ * header for the intended lazy-compensation usage.
+ */
+BME280_INTF_RET_TYPE bme280_pico_i2c_read_burst(struct bme280_pico_i2c_context *ctx,
+                                                uint8_t *frame)
+{
+    uint32_t t0 = perf_begin();
+    bme280_dma_submit(ctx, ctx->burst_cmd, count_of(ctx->burst_cmd),
+                      frame, BME280_LEN_P_T_H_DATA);
+    BME280_INTF_RET_TYPE rslt = bme280_dma_wait(ctx);
+    perf_end(PERF_I2C_XFER, t0);
+    return rslt;
 }
 
 /**
  * @brief I2C write function for Bosch BME280 API
- * 
+ *
  * This function is called by the Bosch API to write data to the BME280 sensor
- * via I2C. It adapts the Bosch API's function signature to Raspberry Pi Pico's
- * I2C functions.
- * 
+ * via I2C. The register address and payload are streamed to the bus as a
+ * single DMA-driven write transaction.
+ *
  * @param reg_addr Register address to write to
  * @param reg_data Buffer containing data to write
  * @param len Number of bytes to write
@@ -90,40 +267,42 @@ BME280_INTF_RET_TYPE bme280_pico_i2c_read(uint8_t reg_addr, uint8_t *reg_data, u
 BME280_INTF_RET_TYPE bme280_pico_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
 {
     struct bme280_pico_i2c_context *ctx = (struct bme280_pico_i2c_context *)intf_ptr;
-    
+
     if (ctx == NULL || reg_data == NULL) {
         return BME280_E_NULL_PTR;
     }
-    
+
     // The Bosch API prepares the buffer differently for single vs burst writes:
     // - Single write: reg_data contains just the data byte
     // - Burst write: reg_data contains data[0], then interleaved reg_addr[1], data[1], reg_addr[2], data[2], ...
     // For I2C, we always write: [reg_addr] + [reg_data buffer]
-    
-    // Allocate buffer for register address + data
-    uint8_t buf[21];  // Max 20 bytes data + 1 byte reg_addr
-    if (len > 20) {
+
+    if (len + 1 > count_of(ctx->cmd_buf)) {
         return BME280_E_INVALID_LEN;
     }
-    
-    buf[0] = reg_addr;
+
+    ctx->cmd_buf[0] = reg_addr;
     for (uint32_t i = 0; i < len; i++) {
-        buf[i + 1] = reg_data[i];
+        uint16_t cmd = reg_data[i];
+        if (i == len - 1) {
+            cmd |= I2C_CMD_STOP;
+        }
+        ctx->cmd_buf[i + 1] = cmd;
     }
-    
-    int ret = i2c_write_blocking(ctx->i2c, ctx->addr, buf, len + 1, false);
-    if (ret != (int)(len + 1)) {
-        return BME280_E_COMM_FAIL;
+    // Single-byte payload: the address entry isn't last, the data entry is
+    if (len == 0) {
+        ctx->cmd_buf[0] |= I2C_CMD_STOP;
     }
-    
-    return BME280_INTF_RET_SUCCESS;
+
+    bme280_dma_submit(ctx, ctx->cmd_buf, len + 1, NULL, 0);
+    return bme280_dma_wait(ctx);
 }
 
 /**
  * @brief Delay function for Bosch BME280 API
- * 
+ *
  * This function provides microsecond delays required by the Bosch API.
- * 
+ *
  * @param period Delay period in microseconds
  * @param intf_ptr Pointer to interface context (unused)
  */
@@ -135,10 +314,11 @@ void bme280_pico_delay_us(uint32_t period, void *intf_ptr)
 
 /**
  * @brief Initialize I2C interface for BME280
- * 
- * This function initializes the Raspberry Pi Pico I2C hardware and sets up
- * the interface context for the Bosch BME280 API.
- * 
+ *
+ * This function initializes the Raspberry Pi Pico I2C hardware, claims two
+ * DMA channels for the transfer engine, and sets up the interface context
+ * for the Bosch BME280 API.
+ *
  * @param ctx Pointer to I2C context structure (output)
  * @param i2c_instance I2C instance to use (i2c0 or i2c1)
  * @param i2c_addr I2C address of BME280 (0x76 or 0x77)
@@ -155,11 +335,112 @@ void bme280_pico_i2c_init(struct bme280_pico_i2c_context *ctx,
 {
     ctx->i2c = i2c_instance;
     ctx->addr = i2c_addr;
-    
+    ctx->dma_busy = false;
+    ctx->tx_only = false;
+    ctx->idle_hook = NULL;
+
     // Initialize I2C
     i2c_init(ctx->i2c, i2c_freq);
     gpio_set_function(sda_pin, GPIO_FUNC_I2C);
     gpio_set_function(scl_pin, GPIO_FUNC_I2C);
     gpio_pull_up(sda_pin);
     gpio_pull_up(scl_pin);
+
+    // Program the initial target address; reprogrammed per transaction when
+    // several contexts share the block
+    i2c_hw_t *hw = i2c_get_hw(ctx->i2c);
+    hw->enable = 0;
+    hw->tar = ctx->addr;
+    hw->enable = 1;
+
+    // Claim the DMA transfer engine
+    ctx->dma_tx_chan = dma_claim_unused_channel(true);
+    ctx->dma_rx_chan = dma_claim_unused_channel(true);
+
+    // Pre-arm the raw-data burst (0xF7..0xFE) so high-rate capture only
+    // submits the transaction
+    ctx->burst_cmd[0] = BME280_REG_DATA;
+    for (uint i = 0; i < BME280_LEN_P_T_H_DATA; i++) {
+        uint16_t cmd = I2C_CMD_READ;
+        if (i == 0) {
+            cmd |= I2C_CMD_RESTART;
+        }
+        if (i == BME280_LEN_P_T_H_DATA - 1) {
+            cmd |= I2C_CMD_STOP;
+        }
+        ctx->burst_cmd[i + 1] = cmd;
+    }
+
+    if (irq_ctx_count < MAX_I2C_CONTEXTS) {
+        irq_ctxs[irq_ctx_count++] = ctx;
+    }
+    if (irq_ctx_count == 1) {
+        irq_add_shared_handler(DMA_IRQ_0, bme280_dma_irq_handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
+
+    printf("I2C: DMA transfer engine ready for addr 0x%02X (tx ch %d, rx ch %d)\n",
+           ctx->addr, ctx->dma_tx_chan, ctx->dma_rx_chan);
+}
+
+/**
+ * @brief Set the idle hook called while a DMA transfer is in flight
+ *
+ * @param ctx Pointer to I2C context structure
+ * @param hook Function to run while waiting for completion, or NULL to busy-wait
+ */
+void bme280_pico_i2c_set_idle_hook(struct bme280_pico_i2c_context *ctx,
+                                   bme280_pico_idle_fn hook)
+{
+    ctx->idle_hook = hook;
+}
+
+/**
+ * @brief Verify the bus works at the currently programmed rate
+ *
+ * Reads the chip-ID register a few times and checks the BME280 signature.
+ * Marginal rates tend to fail intermittently, hence the repeated reads.
+ */
+static bool bme280_pico_i2c_verify(struct bme280_pico_i2c_context *ctx) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint8_t chip_id = 0;
+        BME280_INTF_RET_TYPE rslt = bme280_pico_i2c_read(BME280_REG_CHIP_ID, &chip_id, 1, ctx);
+        if (rslt != BME280_INTF_RET_SUCCESS || chip_id != BME280_CHIP_ID) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Negotiate the fastest working bus speed
+ *
+ * Walks the rate ladder from fast-mode-plus (1 MHz) down through fast mode
+ * (400 kHz) to standard mode (100 kHz), programming each rate and verifying
+ * it with chip-ID readbacks. Falls down the ladder on NACK/timeout; the
+ * achieved rate is reported at boot. A 4-10x cut in per-transaction bus
+ * time directly shrinks the sensor-read window.
+ *
+ * @param ctx Pointer to I2C context structure (bus must be initialized)
+ * @return The verified bus rate in Hz (at worst 100 kHz, unverified)
+ */
+uint bme280_pico_i2c_negotiate_speed(struct bme280_pico_i2c_context *ctx)
+{
+    static const uint ladder[] = {1000 * 1000, 400 * 1000, 100 * 1000};
+
+    for (uint i = 0; i < count_of(ladder); i++) {
+        uint actual = i2c_set_baudrate(ctx->i2c, ladder[i]);
+        if (bme280_pico_i2c_verify(ctx)) {
+            printf("I2C: bus negotiated at %u Hz\n", actual);
+            return actual;
+        }
+        printf("I2C: %u Hz failed verification, falling back\n", ladder[i]);
+    }
+
+    // Nothing verified: pin the bus at standard mode and let the regular
+    // error reporting surface whatever is wrong with the wiring
+    uint actual = i2c_set_baudrate(ctx->i2c, 100 * 1000);
+    printf("I2C: no rate verified, staying at %u Hz\n", actual);
+    return actual;
 }
@@ -1,8 +1,14 @@
 /**
  * BME280 I2C Adapter for Raspberry Pi Pico
- * 
+ *
  * Header file for I2C interface adapter between Bosch Sensortec BME280 Sensor API
  * and Raspberry Pi Pico's I2C hardware.
+ *
+ * Transfers are driven by DMA: the adapter submits the transaction to the I2C
+ * block via two DMA channels and returns the CPU to the caller-provided idle
+ * hook until the completion interrupt fires. The Bosch API callbacks keep
+ * their synchronous contract, but the CPU is free to service other work
+ * (cyw43 async context, BLE events) while the bus transaction is in flight.
  */
 
 #ifndef _BME280_PICO_I2C_H
@@ -11,12 +17,28 @@
 #include "hardware/i2c.h"
 #include "bme280.h"
 
+/**
+ * Idle hook called repeatedly while a DMA transfer is in flight.
+ * Use this to keep servicing other subsystems (e.g. the cyw43 async
+ * context) instead of spinning. May be NULL.
+ */
+typedef void (*bme280_pico_idle_fn)(void);
+
 /**
  * Structure to hold I2C interface context
  */
 struct bme280_pico_i2c_context {
     i2c_inst_t *i2c;
     uint8_t addr;
+
+    // DMA transfer engine state
+    int dma_tx_chan;                  // DMA channel feeding the I2C TX FIFO
+    int dma_rx_chan;                  // DMA channel draining the I2C RX FIFO
+    volatile bool dma_busy;           // true while a transfer is in flight
+    bool tx_only;                     // current transfer is a write (no RX channel)
+    bme280_pico_idle_fn idle_hook;    // called while waiting for completion
+    uint16_t cmd_buf[32];             // 16-bit IC_DATA_CMD entries for the TX channel
+    uint16_t burst_cmd[1 + BME280_LEN_P_T_H_DATA];  // pre-armed 0xF7..0xFE burst
 };
 
 /**
@@ -44,4 +66,39 @@ void bme280_pico_i2c_init(struct bme280_pico_i2c_context *ctx,
                           uint scl_pin,
                           uint i2c_freq);
 
+/**
+ * @brief Set the idle hook called while a DMA transfer is in flight
+ *
+ * The hook runs on the core that submitted the transfer, typically to keep
+ * polling the cyw43 async context so BLE servicing is not starved by sensor
+ * I/O. Pass NULL to busy-wait instead.
+ */
+void bme280_pico_i2c_set_idle_hook(struct bme280_pico_i2c_context *ctx,
+                                   bme280_pico_idle_fn hook);
+
+/**
+ * @brief Burst-read the raw data registers (0xF7..0xFE) into a raw frame
+ *
+ * Lean fast path for high-rate capture: the command words are pre-armed at
+ * init, so each call only submits the DMA transaction — no per-call buffer
+ * building and none of the Bosch API's generalized entry path. The frame
+ * holds uncompensated register bytes; compensate lazily via the bus
+ * manager for the frames that survive downsampling.
+ *
+ * @param ctx Pointer to I2C context structure
+ * @param frame Destination for the BME280_LEN_P_T_H_DATA raw bytes
+ * @return BME280_INTF_RET_SUCCESS on success, non-zero on failure
+ */
+BME280_INTF_RET_TYPE bme280_pico_i2c_read_burst(struct bme280_pico_i2c_context *ctx,
+                                                uint8_t *frame);
+
+/**
+ * @brief Negotiate the fastest working bus speed
+ *
+ * Tries fast-mode-plus (1 MHz), then fast mode (400 kHz), then standard
+ * mode (100 kHz), verifying each rate with chip-ID readbacks.
+ * @return The verified bus rate in Hz
+ */
+uint bme280_pico_i2c_negotiate_speed(struct bme280_pico_i2c_context *ctx);
+
 #endif /* _BME280_PICO_I2C_H */
@@ -0,0 +1,60 @@
+/**
+ * BME280 SPI Adapter for Raspberry Pi Pico
+ *
+ * SPI counterpart to bme280_pico_i2c.c for boards wired to the sensor's
+ * SPI interface, selected with the SENSOR_SPI CMake option. The BME280
+ * runs SPI mode 0 at up to 10 MHz — 100x the I2C standard-mode rate — so
+ * even the largest burst readout completes in ~10 us. That is below the
+ * setup cost of the I2C adapter's DMA engine, so transfers here are plain
+ * blocking FIFO I/O; there is no useful idle window to give back.
+ *
+ * The Bosch API applies the read/write bit to the register address itself
+ * (reg | 0x80 for reads) when dev.intf is BME280_SPI_INTF; the adapter
+ * only frames the transaction with its chip select.
+ */
+
+#ifndef _BME280_PICO_SPI_H
+#define _BME280_PICO_SPI_H
+
+#include "hardware/spi.h"
+#include "bme280.h"
+
+/**
+ * Structure to hold SPI interface context. Sensors share the SPI block
+ * and pins; each context owns only its chip-select line.
+ */
+struct bme280_pico_spi_context {
+    spi_inst_t *spi;
+    uint csn_pin;
+};
+
+/**
+ * @brief SPI read function for Bosch BME280 API
+ */
+BME280_INTF_RET_TYPE bme280_pico_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr);
+
+/**
+ * @brief SPI write function for Bosch BME280 API
+ */
+BME280_INTF_RET_TYPE bme280_pico_spi_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
+
+/**
+ * @brief Delay function for Bosch BME280 API
+ */
+void bme280_pico_spi_delay_us(uint32_t period, void *intf_ptr);
+
+/**
+ * @brief Initialize SPI interface for BME280
+ *
+ * Configures the shared SPI block and pins on first call; later calls for
+ * sensors on the same block only set up their chip select.
+ */
+void bme280_pico_spi_init(struct bme280_pico_spi_context *ctx,
+                          spi_inst_t *spi_instance,
+                          uint sck_pin,
+                          uint mosi_pin,
+                          uint miso_pin,
+                          uint csn_pin,
+                          uint spi_freq);
+
+#endif /* _BME280_PICO_SPI_H */
@@ -7,6 +7,9 @@
 
 // BTstack features that can be enabled
 #define ENABLE_LE_PERIPHERAL
+// Extended advertising (BT 5.0): the batched telemetry set; the CYW43439
+// controller supports it, and we fall back to legacy-only at runtime if not
+#define ENABLE_LE_EXTENDED_ADVERTISING
 #define ENABLE_LOG_INFO
 #define ENABLE_LOG_ERROR
 #define ENABLE_PRINTF_HEXDUMP
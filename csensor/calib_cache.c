@@ -0,0 +1,127 @@
+/**
+ * BME280 Calibration Cache Implementation for CloudPico
+ *
+ * See calib_cache.h for placement and intent. Entries occupy fixed 64-byte
+ * slots in the sector's first page; lookups run straight off the XIP
+ * mapping, writes rebuild the page in RAM and reprogram it through
+ * flash_safe_execute() like the reading log does.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "flash_store.h"
+#include "calib_cache.h"
+
+// Placement: the sector directly below the reading log region
+#define CALIB_CACHE_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE - CALIB_CACHE_SIZE)
+
+#define ENTRY_SIZE 64
+#define ENTRY_COUNT (FLASH_PAGE_SIZE / ENTRY_SIZE)
+#define ENTRY_MAGIC 0xCA
+
+// Fixed-slot cache entry; the calibration struct is stored raw
+typedef struct {
+    uint8_t magic;      // ENTRY_MAGIC when the slot is in use
+    uint8_t addr;       // I2C address
+    uint8_t chip_id;
+    uint8_t checksum;   // 8-bit sum of calib bytes
+    struct bme280_calib_data calib;
+} cache_entry_t;
+
+_Static_assert(sizeof(cache_entry_t) <= ENTRY_SIZE, "cache entry exceeds its slot");
+
+static const cache_entry_t *entry_at(uint32_t idx) {
+    return (const cache_entry_t *)(XIP_BASE + CALIB_CACHE_OFFSET + idx * ENTRY_SIZE);
+}
+
+static uint8_t calib_checksum(const struct bme280_calib_data *calib) {
+    const uint8_t *p = (const uint8_t *)calib;
+    uint8_t sum = 0;
+    for (size_t i = 0; i < sizeof(*calib); i++) {
+        sum += p[i];
+    }
+    return sum;
+}
+
+struct flash_op {
+    uint32_t offset;
+    const uint8_t *data;
+    size_t len;
+};
+
+static void do_flash_program(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_program(op->offset, op->data, op->len);
+}
+
+static void do_flash_erase(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_erase(op->offset, op->len);
+}
+
+bool calib_cache_load(uint8_t addr, uint8_t chip_id, struct bme280_calib_data *out) {
+    for (uint32_t i = 0; i < ENTRY_COUNT; i++) {
+        const cache_entry_t *e = entry_at(i);
+        if (e->magic != ENTRY_MAGIC || e->addr != addr || e->chip_id != chip_id) {
+            continue;
+        }
+        if (calib_checksum(&e->calib) != e->checksum) {
+            printf("Calib cache: bad checksum for 0x%02X, ignoring entry\n", addr);
+            return false;
+        }
+        *out = e->calib;
+        return true;
+    }
+    return false;
+}
+
+void calib_cache_store(uint8_t addr, uint8_t chip_id, const struct bme280_calib_data *calib) {
+    // Rebuild the page in RAM: keep other sensors' entries, replace or
+    // append this one
+    uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+
+    uint32_t slot = ENTRY_COUNT;
+    for (uint32_t i = 0; i < ENTRY_COUNT; i++) {
+        const cache_entry_t *e = entry_at(i);
+        if (e->magic == ENTRY_MAGIC && e->addr != addr) {
+            memcpy(page + i * ENTRY_SIZE, e, sizeof(*e));
+        } else if (slot == ENTRY_COUNT) {
+            slot = i;  // first free (or matching) slot wins
+        }
+    }
+    if (slot == ENTRY_COUNT) {
+        printf("Calib cache: full, not caching 0x%02X\n", addr);
+        return;
+    }
+
+    cache_entry_t entry;
+    memset(&entry, 0xFF, sizeof(entry));
+    entry.magic = ENTRY_MAGIC;
+    entry.addr = addr;
+    entry.chip_id = chip_id;
+    entry.checksum = calib_checksum(calib);
+    entry.calib = *calib;
+    memcpy(page + slot * ENTRY_SIZE, &entry, sizeof(entry));
+
+    struct flash_op op = {
+        .offset = CALIB_CACHE_OFFSET,
+        .data = NULL,
+        .len = FLASH_SECTOR_SIZE,
+    };
+    int rc = flash_safe_execute(do_flash_erase, &op, UINT32_MAX);
+    if (rc != PICO_OK) {
+        printf("Calib cache: sector erase failed (rc %d)\n", rc);
+        return;
+    }
+    op.data = page;
+    op.len = FLASH_PAGE_SIZE;
+    rc = flash_safe_execute(do_flash_program, &op, UINT32_MAX);
+    if (rc != PICO_OK) {
+        printf("Calib cache: program failed (rc %d)\n", rc);
+        return;
+    }
+    printf("Calib cache: stored calibration for 0x%02X\n", addr);
+}
@@ -0,0 +1,42 @@
+/**
+ * BME280 Calibration Cache for CloudPico
+ *
+ * The factory calibration block is fused at manufacture and never changes,
+ * yet every boot re-reads it over the (initially 100 kHz) bus as part of
+ * bme280_init(). This module caches each sensor's compensation parameters
+ * in one flash sector, keyed by I2C address and chip ID, so warm boots skip
+ * the calibration readout and the soft reset and go straight to configuring
+ * the measurement — most of the watchdog-recovery telemetry gap.
+ *
+ * The sector sits directly below the reading log at the top of flash and is
+ * rewritten only when a sensor is seen whose calibration is not yet cached.
+ */
+
+#ifndef CALIB_CACHE_H
+#define CALIB_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/flash.h"
+#include "bme280_defs.h"
+
+// One flash sector holds the cache
+#define CALIB_CACHE_SIZE FLASH_SECTOR_SIZE
+
+/**
+ * Look up cached calibration data for a sensor.
+ * @param addr I2C address the sensor answered on
+ * @param chip_id Chip ID read from the sensor
+ * @param out Filled with the cached compensation parameters on a hit
+ * @return true on a cache hit with a valid checksum
+ */
+bool calib_cache_load(uint8_t addr, uint8_t chip_id, struct bme280_calib_data *out);
+
+/**
+ * Insert (or refresh) a sensor's calibration data in the cache. Rewrites
+ * the sector; a failure is logged and otherwise harmless — the next boot
+ * simply takes the cold path again.
+ */
+void calib_cache_store(uint8_t addr, uint8_t chip_id, const struct bme280_calib_data *calib);
+
+#endif // CALIB_CACHE_H
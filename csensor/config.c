@@ -0,0 +1,223 @@
+/**
+ * Runtime Node Configuration Implementation for CloudPico
+ *
+ * See config.h for the model. The flash side follows reading_seq.c:
+ * memory-mapped reads via XIP, writes through flash_safe_execute(), one
+ * cell per page so every write is a fresh aligned program.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "hardware/flash.h"
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "calib_cache.h"
+#include "flash_store.h"
+#include "config.h"
+
+// Placement: the sector directly below the reading-sequence counter
+#define CONFIG_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE - CALIB_CACHE_SIZE - 2 * FLASH_SECTOR_SIZE)
+
+#define CELL_COUNT (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define CELL_MAGIC 0x43464731u  // "CFG1"
+
+// Compile-time defaults: what a node runs until its first config write
+#ifndef POLL_INTERVAL_MS
+#define POLL_INTERVAL_MS 10000
+#endif
+#ifndef AGG_WINDOW_SAMPLES
+#define AGG_WINDOW_SAMPLES 10
+#endif
+#define CONFIG_DEFAULT_ADV_FAST_MS 800
+#define CONFIG_DEFAULT_ADV_SLOW_MS 6400
+#if defined(SENSOR_PROFILE_PRECISE)
+#define CONFIG_DEFAULT_PROFILE CONFIG_PROFILE_PRECISE
+#elif defined(SENSOR_PROFILE_BALANCED)
+#define CONFIG_DEFAULT_PROFILE CONFIG_PROFILE_BALANCED
+#else
+#define CONFIG_DEFAULT_PROFILE CONFIG_PROFILE_FAST
+#endif
+
+// Accepted ranges; a write with any field outside is rejected whole. The
+// poll ceiling also bounds the watchdog's core-1 budget (wdt.c derives it
+// from the live value).
+#define CONFIG_POLL_MIN_MS 200
+#define CONFIG_POLL_MAX_MS (60 * 60 * 1000)
+#define CONFIG_ADV_MIN_MS 100
+#define CONFIG_ADV_MAX_MS 60000
+#define CONFIG_AGG_WINDOW_MAX 60
+
+// One persisted configuration cell
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t poll_interval_ms;
+    uint16_t adv_fast_ms;
+    uint16_t adv_slow_ms;
+    uint8_t agg_window;
+    uint8_t profile;
+    uint8_t crc8;  // CRC-8 (poly 0x07) of the fields between magic and crc8
+} config_cell_t;
+
+static cloudpico_config_t live = {
+    .poll_interval_ms = POLL_INTERVAL_MS,
+    .adv_fast_ms = CONFIG_DEFAULT_ADV_FAST_MS,
+    .adv_slow_ms = CONFIG_DEFAULT_ADV_SLOW_MS,
+    .agg_window = AGG_WINDOW_SAMPLES,
+    .profile = CONFIG_DEFAULT_PROFILE,
+};
+
+static uint32_t next_cell = 0;
+
+static const config_cell_t *cell_at(uint32_t idx) {
+    return (const config_cell_t *)(XIP_BASE + CONFIG_OFFSET + idx * FLASH_PAGE_SIZE);
+}
+
+static uint8_t cell_crc8(const config_cell_t *c) {
+    const uint8_t *p = (const uint8_t *)c + 4;
+    size_t len = offsetof(config_cell_t, crc8) - 4;
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+struct flash_op {
+    uint32_t offset;
+    const uint8_t *data;
+    size_t len;
+};
+
+static void do_flash_program(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_program(op->offset, op->data, op->len);
+}
+
+static void do_flash_erase(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_erase(op->offset, op->len);
+}
+
+/**
+ * Persist the live configuration as a fresh cell, erasing the sector when
+ * all cells are used.
+ */
+static void persist(void) {
+    if (next_cell == CELL_COUNT) {
+        struct flash_op op = {
+            .offset = CONFIG_OFFSET,
+            .data = NULL,
+            .len = FLASH_SECTOR_SIZE,
+        };
+        if (flash_safe_execute(do_flash_erase, &op, UINT32_MAX) != PICO_OK) {
+            printf("Config: sector erase failed\n");
+            return;
+        }
+        next_cell = 0;
+    }
+
+    config_cell_t cell;
+    cell.magic = CELL_MAGIC;
+    cell.poll_interval_ms = live.poll_interval_ms;
+    cell.adv_fast_ms = live.adv_fast_ms;
+    cell.adv_slow_ms = live.adv_slow_ms;
+    cell.agg_window = live.agg_window;
+    cell.profile = live.profile;
+    cell.crc8 = cell_crc8(&cell);
+
+    uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &cell, sizeof(cell));
+
+    struct flash_op op = {
+        .offset = CONFIG_OFFSET + next_cell * FLASH_PAGE_SIZE,
+        .data = page,
+        .len = FLASH_PAGE_SIZE,
+    };
+    if (flash_safe_execute(do_flash_program, &op, UINT32_MAX) != PICO_OK) {
+        printf("Config: cell program failed\n");
+        return;
+    }
+    next_cell++;
+}
+
+void config_init(void) {
+    // Newest valid cell wins; cells are written in order, so the first
+    // invalid slot ends the scan. A cell torn by power loss fails its CRC
+    // and the node keeps the previous cell (or the defaults).
+    bool found = false;
+    for (next_cell = 0; next_cell < CELL_COUNT; next_cell++) {
+        const config_cell_t *c = cell_at(next_cell);
+        if (c->magic != CELL_MAGIC) {
+            break;
+        }
+        if (c->crc8 != cell_crc8(c)) {
+            continue;
+        }
+        live.poll_interval_ms = c->poll_interval_ms;
+        live.adv_fast_ms = c->adv_fast_ms;
+        live.adv_slow_ms = c->adv_slow_ms;
+        live.agg_window = c->agg_window;
+        live.profile = c->profile;
+        found = true;
+    }
+
+    printf("Config: poll %lu ms, adv %u..%u ms, agg window %u, profile %u (%s)\n",
+           (unsigned long)live.poll_interval_ms, live.adv_fast_ms, live.adv_slow_ms,
+           live.agg_window, live.profile, found ? "flash" : "defaults");
+}
+
+const cloudpico_config_t *config_get(void) {
+    return &live;
+}
+
+void config_pack(uint8_t *blob) {
+    blob[0] = (uint8_t)(live.poll_interval_ms & 0xFF);
+    blob[1] = (uint8_t)((live.poll_interval_ms >> 8) & 0xFF);
+    blob[2] = (uint8_t)((live.poll_interval_ms >> 16) & 0xFF);
+    blob[3] = (uint8_t)((live.poll_interval_ms >> 24) & 0xFF);
+    blob[4] = (uint8_t)(live.adv_fast_ms & 0xFF);
+    blob[5] = (uint8_t)((live.adv_fast_ms >> 8) & 0xFF);
+    blob[6] = (uint8_t)(live.adv_slow_ms & 0xFF);
+    blob[7] = (uint8_t)((live.adv_slow_ms >> 8) & 0xFF);
+    blob[8] = live.agg_window;
+    blob[9] = live.profile;
+}
+
+int config_apply_blob(const uint8_t *blob, uint16_t len) {
+    if (len != CONFIG_BLOB_LEN) {
+        return -1;
+    }
+
+    uint32_t poll = (uint32_t)blob[0] | ((uint32_t)blob[1] << 8) |
+                    ((uint32_t)blob[2] << 16) | ((uint32_t)blob[3] << 24);
+    uint16_t fast = (uint16_t)(blob[4] | (blob[5] << 8));
+    uint16_t slow = (uint16_t)(blob[6] | (blob[7] << 8));
+    uint8_t agg = blob[8];
+    uint8_t profile = blob[9];
+
+    if (poll < CONFIG_POLL_MIN_MS || poll > CONFIG_POLL_MAX_MS ||
+        fast < CONFIG_ADV_MIN_MS || fast > CONFIG_ADV_MAX_MS ||
+        slow < fast || slow > CONFIG_ADV_MAX_MS ||
+        agg < 1 || agg > CONFIG_AGG_WINDOW_MAX ||
+        profile >= CONFIG_PROFILE_COUNT) {
+        return -1;
+    }
+
+    // Field stores are aligned and word-sized or smaller, so core 1 sees
+    // each value either old or new — never torn
+    live.poll_interval_ms = poll;
+    live.adv_fast_ms = fast;
+    live.adv_slow_ms = slow;
+    live.agg_window = agg;
+    live.profile = profile;
+
+    persist();
+    printf("Config: applied poll %lu ms, adv %u..%u ms, agg window %u, profile %u\n",
+           (unsigned long)poll, fast, slow, agg, profile);
+    return 0;
+}
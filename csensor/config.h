@@ -0,0 +1,73 @@
+/**
+ * Runtime Node Configuration for CloudPico
+ *
+ * Tunables that used to be compile-time-only (poll interval, advertising
+ * interval ladder, aggregation window, sensor profile) live in one small
+ * config struct, persisted in flash and writable over GATT — so a node's
+ * rate/power tradeoff is set per site from the gateway instead of by
+ * reflashing. The compile-time cache variables remain as the defaults a
+ * node boots with until its first configuration write.
+ *
+ * Poll, advertising and aggregation values take effect on the next cycle;
+ * the sensor profile programs the BME280 oversampling registers during
+ * bus init and therefore applies on the next boot.
+ *
+ * Persistence follows reading_seq.c: one cell per flash page in a
+ * dedicated sector, newest valid cell wins, sector erase only when all
+ * cells are used. Cells are CRC-framed like the reading log's records.
+ */
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sensor conversion profile indices; sensor_bus.c keeps the matching
+// oversampling/filter table
+typedef enum {
+    CONFIG_PROFILE_FAST = 0,
+    CONFIG_PROFILE_BALANCED = 1,
+    CONFIG_PROFILE_PRECISE = 2,
+    CONFIG_PROFILE_COUNT
+} config_profile_t;
+
+typedef struct {
+    uint32_t poll_interval_ms;  // sampling cadence (core 1)
+    uint16_t adv_fast_ms;       // adaptive advertising ladder, fast end
+    uint16_t adv_slow_ms;       // adaptive advertising ladder, slow end
+    uint8_t agg_window;         // readings per aggregation window
+    uint8_t profile;            // config_profile_t; applied at next boot
+} cloudpico_config_t;
+
+// Wire size of the packed config (the GATT characteristic value):
+// poll u32 + fast u16 + slow u16 + agg u8 + profile u8, little-endian
+#define CONFIG_BLOB_LEN 10
+
+/**
+ * Load the persisted configuration, falling back to the compile-time
+ * defaults when no valid cell exists. Call before anything that reads the
+ * config (sensor bus init, BLE init, watchdog arm).
+ */
+void config_init(void);
+
+/**
+ * The live configuration. Fields are plain aligned loads, safe to read
+ * from either core; writes happen only through config_apply_blob() on
+ * core 0.
+ */
+const cloudpico_config_t *config_get(void);
+
+/**
+ * Pack the live configuration into its wire form (CONFIG_BLOB_LEN bytes).
+ */
+void config_pack(uint8_t *blob);
+
+/**
+ * Validate a packed configuration, apply it live and persist it.
+ * @return 0 on success, negative if any field is out of range (the live
+ *         configuration is untouched in that case)
+ */
+int config_apply_blob(const uint8_t *blob, uint16_t len);
+
+#endif /* _CONFIG_H */
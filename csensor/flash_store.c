@@ -0,0 +1,274 @@
+/**
+ * Persistent Reading Store for CloudPico
+ *
+ * See flash_store.h for the record format and API. The region lives at the
+ * top of flash (the firmware occupies the bottom) and is treated as a ring
+ * of 16-byte record slots. Programming goes through flash_safe_execute() so
+ * XIP stalls are coordinated with the other core; core 1 registers itself
+ * with flash_safe_execute_core_init() at task start.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "flash_store.h"
+
+// Region placement: topmost FLASH_STORE_SIZE bytes of flash
+#define FLASH_STORE_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE)
+
+#define RECORD_SIZE sizeof(flash_record_t)
+#define RECORDS_PER_PAGE (FLASH_PAGE_SIZE / RECORD_SIZE)
+#define RECORDS_PER_SECTOR (FLASH_SECTOR_SIZE / RECORD_SIZE)
+#define TOTAL_RECORDS (FLASH_STORE_SIZE / RECORD_SIZE)
+
+// Memory-mapped view of the log region
+static const flash_record_t *record_at(uint32_t idx) {
+    return (const flash_record_t *)(XIP_BASE + FLASH_STORE_OFFSET + idx * RECORD_SIZE);
+}
+
+// Ring state: slot indices into the region
+static uint32_t write_idx = 0;   // next flash slot to be programmed
+static uint32_t drain_idx = 0;   // oldest unacknowledged slot
+// Slots between drain cursor and write head. Counts padding slots from
+// flushed partial pages too; the drain path skips those transparently.
+static uint32_t pending = 0;
+
+// RAM staging page: records accumulate here until a full page is ready
+static uint8_t staging[FLASH_PAGE_SIZE];
+static uint32_t staged = 0;      // records currently in staging
+
+// Arguments for the flash operations run under flash_safe_execute()
+struct flash_op {
+    uint32_t offset;
+    const uint8_t *data;
+    size_t len;
+};
+
+static void do_flash_program(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_program(op->offset, op->data, op->len);
+}
+
+static void do_flash_erase(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_erase(op->offset, op->len);
+}
+
+// CRC-8, polynomial 0x07, over the record's payload bytes (everything
+// after the crc8 field)
+static uint8_t record_crc8(const flash_record_t *r) {
+    const uint8_t *p = (const uint8_t *)r + 1;
+    uint8_t crc = 0;
+    for (size_t i = 0; i < RECORD_SIZE - 1; i++) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static bool record_valid(const flash_record_t *r) {
+    // Erased slots are all 0xFF; everything else must pass the CRC, which
+    // rejects records torn by power loss mid-program
+    const uint8_t *p = (const uint8_t *)r;
+    bool erased = true;
+    for (size_t i = 0; i < RECORD_SIZE; i++) {
+        if (p[i] != 0xFF) {
+            erased = false;
+            break;
+        }
+    }
+    if (erased) {
+        return false;
+    }
+    return r->crc8 == record_crc8(r);
+}
+
+/**
+ * Erase the sector containing the given slot. Any pending records inside it
+ * are lost (the ring has wrapped onto them); the drain cursor is advanced
+ * past the erased range so it never reads stale data.
+ */
+static int erase_sector_of(uint32_t idx) {
+    uint32_t sector_first = (idx / RECORDS_PER_SECTOR) * RECORDS_PER_SECTOR;
+
+    // Account for unacked records about to be destroyed
+    while (pending > 0 &&
+           drain_idx >= sector_first &&
+           drain_idx < sector_first + RECORDS_PER_SECTOR) {
+        drain_idx = (drain_idx + 1) % TOTAL_RECORDS;
+        pending--;
+    }
+
+    struct flash_op op = {
+        .offset = FLASH_STORE_OFFSET + sector_first * RECORD_SIZE,
+        .data = NULL,
+        .len = FLASH_SECTOR_SIZE,
+    };
+    int rc = flash_safe_execute(do_flash_erase, &op, UINT32_MAX);
+    if (rc != PICO_OK) {
+        printf("Flash store: sector erase failed (rc %d)\n", rc);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Program the staging page at the write head and advance the ring.
+ */
+static int commit_staging(void) {
+    if (staged == 0) {
+        return 0;
+    }
+
+    // Pad the remainder of the page with erased slots
+    memset(staging + staged * RECORD_SIZE, 0xFF, (RECORDS_PER_PAGE - staged) * RECORD_SIZE);
+
+    // Entering a fresh sector: erase it (drops the oldest wrapped records)
+    if (write_idx % RECORDS_PER_SECTOR == 0) {
+        if (erase_sector_of(write_idx) != 0) {
+            return -1;
+        }
+    }
+
+    struct flash_op op = {
+        .offset = FLASH_STORE_OFFSET + write_idx * RECORD_SIZE,
+        .data = staging,
+        .len = FLASH_PAGE_SIZE,
+    };
+    int rc = flash_safe_execute(do_flash_program, &op, UINT32_MAX);
+    if (rc != PICO_OK) {
+        printf("Flash store: page program failed (rc %d)\n", rc);
+        return -1;
+    }
+
+    pending += RECORDS_PER_PAGE;
+    write_idx = (write_idx + RECORDS_PER_PAGE) % TOTAL_RECORDS;
+    staged = 0;
+    return 0;
+}
+
+int flash_store_init(void) {
+    // Locate the newest and oldest valid records by reading_id. The region
+    // is a ring, so the head is one page past the newest record's page.
+    bool found = false;
+    uint32_t newest_idx = 0, oldest_idx = 0;
+    uint32_t newest_id = 0, oldest_id = UINT32_MAX;
+    uint32_t valid = 0;
+
+    for (uint32_t i = 0; i < TOTAL_RECORDS; i++) {
+        const flash_record_t *r = record_at(i);
+        if (!record_valid(r)) {
+            continue;
+        }
+        valid++;
+        if (!found || r->reading_id > newest_id) {
+            newest_id = r->reading_id;
+            newest_idx = i;
+        }
+        if (!found || r->reading_id < oldest_id) {
+            oldest_id = r->reading_id;
+            oldest_idx = i;
+        }
+        found = true;
+    }
+
+    if (!found) {
+        write_idx = 0;
+        drain_idx = 0;
+        pending = 0;
+        printf("Flash store: empty log, %u record capacity at offset 0x%08x\n",
+               (unsigned)TOTAL_RECORDS, (unsigned)FLASH_STORE_OFFSET);
+        return 0;
+    }
+
+    // Resume writing at the next page boundary after the newest record
+    write_idx = ((newest_idx / RECORDS_PER_PAGE) + 1) * RECORDS_PER_PAGE % TOTAL_RECORDS;
+    drain_idx = oldest_idx;
+    pending = (write_idx + TOTAL_RECORDS - drain_idx) % TOTAL_RECORDS;
+    // Fully wrapped ring: the resumed head lands exactly on the oldest
+    // record and the modulo distance reads as empty. The scan knows better
+    // — keep the whole persisted backlog instead of abandoning it.
+    if (pending == 0) {
+        pending = valid;
+    }
+    staged = 0;
+
+    printf("Flash store: resuming, %u valid records pending (ids %u..%u)\n",
+           (unsigned)valid, (unsigned)oldest_id, (unsigned)newest_id);
+    return 0;
+}
+
+int flash_store_append(uint8_t sensor_id, uint32_t reading_id, const sensor_data_t *data) {
+    // Staging still full means the maintenance commit hasn't run since the
+    // page filled; commit inline rather than lose the reading
+    if (staged == RECORDS_PER_PAGE) {
+        printf("Flash store: staging full, committing inline\n");
+        if (commit_staging() != 0) {
+            return -1;
+        }
+    }
+
+    flash_record_t rec;
+    rec.sensor_id = sensor_id;
+    rec.reading_id = reading_id;
+    rec.uptime_s = to_ms_since_boot(get_absolute_time()) / 1000;
+    // Readings already carry the wire units; just narrow to the record fields
+    rec.temp_centi = (int16_t)data->temp_centi;
+    rec.press_deci = (uint16_t)data->press_deci;
+    rec.hum_centi = (uint16_t)data->hum_centi;
+    rec.crc8 = record_crc8(&rec);
+
+    memcpy(staging + staged * RECORD_SIZE, &rec, RECORD_SIZE);
+    staged++;
+    return 0;
+}
+
+int flash_store_commit_maybe(void) {
+    if (staged < RECORDS_PER_PAGE) {
+        return 0;
+    }
+    return commit_staging();
+}
+
+int flash_store_flush(void) {
+    // Padding a partial page wastes the remaining slots of that page, but
+    // the ring arithmetic stays page-aligned
+    if (staged == 0) {
+        return 0;
+    }
+    int rc = commit_staging();
+    if (rc == 0) {
+        // Skip the padded remainder: write head already moved a full page
+        return 0;
+    }
+    return rc;
+}
+
+uint32_t flash_store_pending(void) {
+    return pending;
+}
+
+bool flash_store_drain_peek(flash_record_t *out) {
+    while (pending > 0) {
+        const flash_record_t *r = record_at(drain_idx);
+        if (record_valid(r)) {
+            *out = *r;
+            return true;
+        }
+        // Padding slot from a flushed partial page: skip it
+        drain_idx = (drain_idx + 1) % TOTAL_RECORDS;
+        pending--;
+    }
+    return false;
+}
+
+void flash_store_drain_ack(void) {
+    if (pending > 0) {
+        drain_idx = (drain_idx + 1) % TOTAL_RECORDS;
+        pending--;
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * Persistent Reading Store for CloudPico
+ *
+ * Circular log of compensated readings in the top of the RP2040's XIP flash.
+ * Records are fixed-size (16 bytes) and staged in a RAM page buffer; flash is
+ * programmed one 256-byte page at a time so the 4 KB sector-erase cost is
+ * amortized over 256 records. The log wraps over FLASH_STORE_SIZE bytes,
+ * which spreads wear evenly across the region.
+ *
+ * Readings survive gateway outages: a drain cursor walks the log from the
+ * oldest unacknowledged record, and records are released only once the
+ * consumer acknowledges them (e.g. after a successful bulk transfer).
+ *
+ * Brownout safety: every record is framed by a CRC-8 over its payload
+ * bytes, so a page torn by power loss mid-program decodes as invalid
+ * slots rather than corrupt readings — init and drain simply skip them.
+ * Appends only stage into RAM; the page program (and the sector erase
+ * ahead of it) runs from flash_store_commit_maybe(), which the core-0
+ * maintenance task calls at its scheduled quiet point so the XIP stall
+ * never lands inside the publish path.
+ */
+
+#ifndef _FLASH_STORE_H
+#define _FLASH_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_advertise.h"
+
+// Size of the log region at the top of flash. 256 KB = 64 sectors =
+// 16384 records, about 45 hours of history at 10 s polling.
+#ifndef FLASH_STORE_SIZE
+#define FLASH_STORE_SIZE (256 * 1024)
+#endif
+
+// One stored reading. Packed to exactly 16 bytes so records never straddle
+// a flash page boundary. A record is valid when crc8 matches the CRC-8 of
+// the 15 payload bytes that follow it; all-0xFF slots are erased, anything
+// else (torn program, bit rot) fails the CRC and is skipped.
+typedef struct __attribute__((packed)) {
+    uint8_t crc8;         // CRC-8 (poly 0x07) of the remaining 15 bytes
+    uint8_t sensor_id;    // sensor bus slot that took the reading
+    uint32_t reading_id;  // that sensor's monotonic reading counter
+    uint32_t uptime_s;    // seconds since boot when the reading was taken
+    int16_t temp_centi;   // centi-degC
+    uint16_t press_deci;  // deci-hPa
+    uint16_t hum_centi;   // centi-%RH
+} flash_record_t;
+
+/**
+ * Initialize the store: locate the write head by scanning for the newest
+ * valid record and position the drain cursor at the oldest one.
+ * @return 0 on success, negative on an unusable flash region
+ */
+int flash_store_init(void);
+
+/**
+ * Append a reading to the log. The record lands in the RAM staging page;
+ * programming is deferred to flash_store_commit_maybe(). If the staging
+ * page is still full because commits have stalled, the page is committed
+ * inline as a last resort before staging the new record.
+ * @param sensor_id Sensor bus slot that took the reading
+ * @param reading_id That sensor's monotonic reading counter
+ * @param data Compensated reading
+ * @return 0 on success, negative on flash programming failure
+ */
+int flash_store_append(uint8_t sensor_id, uint32_t reading_id, const sensor_data_t *data);
+
+/**
+ * Program the staging page if it has filled. Called from the maintenance
+ * task's scheduled slot, so the XIP stall for the program (and any sector
+ * erase ahead of it) happens at a known quiet point instead of inside the
+ * reading publish path.
+ * @return 0 on success or nothing to do, negative on programming failure
+ */
+int flash_store_commit_maybe(void);
+
+/**
+ * Force the staging page out to flash (e.g. before a planned reset).
+ * Partially-filled pages are padded with erased slots.
+ * @return 0 on success, negative on flash programming failure
+ */
+int flash_store_flush(void);
+
+/**
+ * Number of records between the drain cursor and the write head.
+ */
+uint32_t flash_store_pending(void);
+
+/**
+ * Read the record at the drain cursor without consuming it.
+ * @return true if a pending record was copied to *out
+ */
+bool flash_store_drain_peek(flash_record_t *out);
+
+/**
+ * Acknowledge the record at the drain cursor, advancing it. Call after the
+ * record has been delivered (e.g. notified over GATT and confirmed).
+ */
+void flash_store_drain_ack(void);
+
+#endif /* _FLASH_STORE_H */
@@ -0,0 +1,156 @@
+/**
+ * Deferred Ring-Pool Logging Implementation for CloudPico
+ *
+ * See log.h for the model. The producer side is a plain slot write plus a
+ * barrier and an index increment; it never inspects the consumer index, so
+ * a full ring silently overwrites its oldest record instead of blocking.
+ * The drain detects the overwrite from the sequence distance and skips
+ * forward, counting what was lost. A record copied while the producer was
+ * lapping it is discarded by re-checking the head afterwards.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "log.h"
+
+// Records per core; must be a power of two (index arithmetic uses masking)
+#define LOG_RING_CAPACITY 64
+
+// Records formatted per drain call, so one maintenance tick never spends
+// more than a bounded slice on log output
+#define LOG_DRAIN_BUDGET 16
+
+typedef struct {
+    uint32_t seq;     // sequence number the record was written under
+    uint32_t t_ms;    // ms since boot at the event
+    uint8_t event;    // log_event_t
+    uint8_t tag;
+    int32_t a, b, c, d;
+} log_record_t;
+
+// head is owned by the producing core, tail by the core-0 drain
+typedef struct {
+    log_record_t slots[LOG_RING_CAPACITY];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t dropped;  // drain-side count of records lost to overwrite
+} log_ring_t;
+
+static log_ring_t rings[2];  // one per core
+
+void log_event(uint8_t event, uint8_t tag, int32_t a, int32_t b, int32_t c, int32_t d) {
+    log_ring_t *r = &rings[get_core_num()];
+    uint32_t head = r->head;
+    log_record_t *rec = &r->slots[head & (LOG_RING_CAPACITY - 1)];
+
+    rec->seq = head;
+    rec->t_ms = to_ms_since_boot(get_absolute_time());
+    rec->event = event;
+    rec->tag = tag;
+    rec->a = a;
+    rec->b = b;
+    rec->c = c;
+    rec->d = d;
+
+    __dmb();  // record contents must be visible before the index moves
+    r->head = head + 1;
+}
+
+/**
+ * Format one record in the style of the printf lines it replaced, prefixed
+ * with the event's capture time so deferred output stays attributable.
+ */
+static void log_print(const log_record_t *rec) {
+    printf("[%6lu.%03lu] ", (unsigned long)(rec->t_ms / 1000),
+           (unsigned long)(rec->t_ms % 1000));
+
+    switch (rec->event) {
+        case LOG_EVT_READING:
+            printf("Sensor %u: T=%ld.%02ld C  P=%ld.%01ld hPa  H=%ld.%02ld %%\n",
+                   rec->tag,
+                   (long)(rec->a / 100),
+                   (long)(rec->a < 0 ? -rec->a % 100 : rec->a % 100),
+                   (long)(rec->b / 10), (long)(rec->b % 10),
+                   (long)(rec->c / 100), (long)(rec->c % 100));
+            break;
+        case LOG_EVT_QUEUE_FULL:
+            printf("Sensor %u: reading queue full, dropping reading\n", rec->tag);
+            break;
+        case LOG_EVT_ADV_UPDATE:
+            printf("BLE: Updated advertisement (sensor: %u, reading_id: %lu, "
+                   "T: %ld centi-degC, P: %ld deci-hPa, H: %ld centi-%%RH)\n",
+                   rec->tag, (unsigned long)rec->a, (long)rec->b,
+                   (long)rec->c, (long)rec->d);
+            break;
+        case LOG_EVT_ADV_INTERVAL:
+            printf("BLE: %s, advertising interval -> %ld ms\n",
+                   rec->tag ? "burst" : "quiet", (long)rec->a);
+            break;
+        case LOG_EVT_AGG:
+            printf("BLE: aggregate (sensor: %u, n: %lu, T: %ld..%ld mean %ld sd %lu)\n",
+                   rec->tag, (unsigned long)((uint32_t)rec->d >> 16),
+                   (long)rec->a, (long)rec->b, (long)rec->c,
+                   (unsigned long)((uint32_t)rec->d & 0xFFFF));
+            break;
+        default:
+            printf("log: unknown event %u (%ld, %ld, %ld, %ld)\n",
+                   rec->event, (long)rec->a, (long)rec->b, (long)rec->c, (long)rec->d);
+            break;
+    }
+}
+
+/**
+ * Drain up to budget records from one ring. Lap handling: if the producer
+ * has advanced more than a full capacity past the tail, the oldest records
+ * were overwritten — skip to the oldest safe slot (one short of capacity,
+ * since the producer may be mid-write on the very oldest) and count the
+ * loss. The same head re-check after copying discards a torn record.
+ */
+static int ring_drain(log_ring_t *r, int budget) {
+    int printed = 0;
+    while (printed < budget) {
+        uint32_t head = r->head;
+        uint32_t tail = r->tail;
+        if (head == tail) {
+            break;
+        }
+        if (head - tail >= LOG_RING_CAPACITY) {
+            uint32_t skip_to = head - LOG_RING_CAPACITY + 1;
+            r->dropped += skip_to - tail;
+            tail = skip_to;
+            // Persist the cursor now (the drain side owns it): a torn-copy
+            // retry below reloads r->tail and must not re-count this skip
+            r->tail = tail;
+        }
+
+        __dmb();
+        log_record_t rec = r->slots[tail & (LOG_RING_CAPACITY - 1)];
+        __dmb();
+        if (r->head - tail >= LOG_RING_CAPACITY) {
+            continue;  // producer lapped us mid-copy; re-resolve the tail
+        }
+
+        log_print(&rec);
+        printed++;
+        r->tail = tail + 1;
+    }
+
+    if (r->dropped > 0 && printed < budget) {
+        printf("log: %lu record(s) lost to ring overwrite\n", (unsigned long)r->dropped);
+        r->dropped = 0;
+    }
+    return printed;
+}
+
+void log_drain_maybe(void) {
+    // No host draining CDC: leave everything in the rings. Formatting (and
+    // the CDC buffer it would fill) is the whole cost this module defers.
+    if (!stdio_usb_connected()) {
+        return;
+    }
+
+    int budget = LOG_DRAIN_BUDGET;
+    budget -= ring_drain(&rings[0], budget);
+    ring_drain(&rings[1], budget);
+}
@@ -0,0 +1,47 @@
+/**
+ * Deferred Ring-Pool Logging for CloudPico
+ *
+ * The per-reading printf calls used to format and push bytes into the USB
+ * CDC buffer from the hot path; with no host draining the endpoint that
+ * can stall, and formatting alone costs microseconds per event. Instead,
+ * hot-path code drops a fixed-size binary record into a static ring and
+ * returns in a handful of cycles; the maintenance task formats and prints
+ * records later, and only while a USB host is actually connected — a
+ * battery node with nobody listening pays nothing for its logs.
+ *
+ * One ring per core, single-producer/single-consumer like sensor_queue.h
+ * (the RP2040's M0+ cores have no cross-core atomic read-modify-write, so
+ * a shared multi-producer ring would need a spinlock on this path). Each
+ * ring overwrites its oldest record when full; the drain detects the lap
+ * and reports the number of records lost.
+ */
+
+#ifndef _LOG_H
+#define _LOG_H
+
+#include <stdint.h>
+
+// Event kinds; the drain owns one format string per kind
+typedef enum {
+    LOG_EVT_READING = 1,     // tag=sensor, a=temp_centi, b=press_deci, c=hum_centi
+    LOG_EVT_QUEUE_FULL,      // tag=sensor
+    LOG_EVT_ADV_UPDATE,      // tag=sensor, a=reading_id, b=temp, c=press, d=hum
+    LOG_EVT_ADV_INTERVAL,    // tag=1 burst / 0 quiet, a=interval_ms
+    LOG_EVT_AGG,             // tag=sensor, a=temp min, b=max, c=mean, d=(count<<16)|sd
+} log_event_t;
+
+/**
+ * Record one event. Safe from either core and from any context; never
+ * blocks, never formats. Unused arguments are conventionally 0.
+ */
+void log_event(uint8_t event, uint8_t tag, int32_t a, int32_t b, int32_t c, int32_t d);
+
+/**
+ * Format and print pending records over USB stdio, bounded per call so the
+ * maintenance task's deadline holds. Does nothing (and drops nothing) when
+ * no USB host is connected — records simply wait in the rings, oldest
+ * falling off once a ring wraps.
+ */
+void log_drain_maybe(void);
+
+#endif /* _LOG_H */
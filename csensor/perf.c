@@ -0,0 +1,81 @@
+/**
+ * Hot-Path Cycle Instrumentation for CloudPico
+ *
+ * See perf.h. Reading SysTick's current-value register and a couple of
+ * additions costs ~20 cycles per section, low enough to leave enabled in
+ * production builds.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/structs/systick.h"
+#include "perf.h"
+
+// Seconds between reports over USB stdio
+#define PERF_REPORT_INTERVAL_MS 30000
+
+// SysTick is a 24-bit down-counter
+#define SYSTICK_MASK 0x00FFFFFFu
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} perf_counter_t;
+
+static perf_counter_t counters[PERF_COUNTER_COUNT] = {
+    [PERF_I2C_XFER]   = {.name = "i2c_xfer",   .min_cycles = UINT32_MAX},
+    [PERF_COMPENSATE] = {.name = "compensate", .min_cycles = UINT32_MAX},
+    [PERF_ADV_ENCODE] = {.name = "adv_encode", .min_cycles = UINT32_MAX},
+    [PERF_ASYNC_POLL] = {.name = "async_poll", .min_cycles = UINT32_MAX},
+};
+
+static absolute_time_t next_report;
+
+void perf_core_init(void) {
+    // Free-run from the processor clock with the full 24-bit range.
+    // CSR bits by value (CLKSOURCE | ENABLE) — the macro names differ
+    // between the M0+ and M33 SDK headers.
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = (1u << 2) | (1u << 0);
+
+    next_report = make_timeout_time_ms(PERF_REPORT_INTERVAL_MS);
+}
+
+uint32_t perf_begin(void) {
+    return systick_hw->cvr;
+}
+
+void perf_end(perf_id_t id, uint32_t start) {
+    // Down-counter: elapsed = start - now, modulo the 24-bit range
+    uint32_t elapsed = (start - systick_hw->cvr) & SYSTICK_MASK;
+
+    perf_counter_t *c = &counters[id];
+    c->count++;
+    c->total_cycles += elapsed;
+    if (elapsed < c->min_cycles) c->min_cycles = elapsed;
+    if (elapsed > c->max_cycles) c->max_cycles = elapsed;
+}
+
+void perf_report_maybe(void) {
+    if (!time_reached(next_report)) {
+        return;
+    }
+    next_report = make_timeout_time_ms(PERF_REPORT_INTERVAL_MS);
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf_counter_t *c = &counters[i];
+        if (c->count == 0) {
+            continue;
+        }
+        printf("perf: %-10s n=%lu min=%lu mean=%lu max=%lu cycles\n",
+               c->name,
+               (unsigned long)c->count,
+               (unsigned long)c->min_cycles,
+               (unsigned long)(c->total_cycles / c->count),
+               (unsigned long)c->max_cycles);
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * Hot-Path Cycle Instrumentation for CloudPico
+ *
+ * Lightweight SysTick-based cycle counters around the paths where loop time
+ * actually goes: the I2C transaction, the Bosch compensation, the payload
+ * encode and the cyw43 async poll. Each counter accumulates count/min/max/
+ * total and a one-line report is emitted periodically over the existing USB
+ * stdio, so field jitter can be attributed to I2C clock stretching, cyw43
+ * bus contention or BTstack without reflashing.
+ *
+ * SysTick is per-core and free-running from the processor clock (24-bit
+ * wrap, ~134 ms at 125 MHz — far above any measured section). Counters are
+ * single-writer: each is only ever updated from the core that owns its code
+ * path, so no cross-core synchronization is needed.
+ */
+
+#ifndef _PERF_H
+#define _PERF_H
+
+#include <stdint.h>
+
+// Instrumented sections
+typedef enum {
+    PERF_I2C_XFER = 0,    // DMA I2C transaction, submit to completion (core 1)
+    PERF_COMPENSATE,      // bme280_get_sensor_data incl. readout (core 1)
+    PERF_ADV_ENCODE,      // payload encode + frame build (core 0)
+    PERF_ASYNC_POLL,      // async_context_poll (core 0)
+    PERF_COUNTER_COUNT
+} perf_id_t;
+
+/**
+ * Start the calling core's SysTick free-running. Call once per core before
+ * taking measurements on it.
+ */
+void perf_core_init(void);
+
+/**
+ * Timestamp the start of a section.
+ * @return Opaque start tick for perf_end()
+ */
+uint32_t perf_begin(void);
+
+/**
+ * Close a section and fold the elapsed cycles into its counter.
+ * @param id Section identifier
+ * @param start Tick returned by perf_begin()
+ */
+void perf_end(perf_id_t id, uint32_t start);
+
+/**
+ * Emit the one-line per-counter report if the report interval has elapsed.
+ * Call from the core-0 loop; cheap when the interval hasn't passed.
+ */
+void perf_report_maybe(void);
+
+#endif /* _PERF_H */
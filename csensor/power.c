@@ -0,0 +1,43 @@
+/**
+ * Low-Power Scheduling for CloudPico
+ *
+ * See power.h for the profile description. The deep-sleep path keeps the
+ * system timer running (it is in the always-on domain), so absolute_time_t
+ * deadlines stay valid across sleeps and the cyw43 driver on core 0 never
+ * observes a time jump.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/structs/scb.h"
+#include "power.h"
+
+#ifndef LOW_POWER
+#define LOW_POWER 0
+#endif
+
+void power_init(void) {
+#if LOW_POWER
+    printf("Power: low-power profile (forced-mode sampling, deep sleep between polls)\n");
+#else
+    printf("Power: standard profile\n");
+#endif
+}
+
+void power_sleep_until(absolute_time_t until) {
+#if LOW_POWER
+    // SLEEPDEEP gates most of the core's clock tree during WFI; the timer
+    // alarm armed by sleep_until() wakes it at the deadline.
+#if PICO_RP2040
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+    sleep_until(until);
+    scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+#else
+    scb_hw->scr |= M33_SCR_SLEEPDEEP_BITS;
+    sleep_until(until);
+    scb_hw->scr &= ~M33_SCR_SLEEPDEEP_BITS;
+#endif
+#else
+    sleep_until(until);
+#endif
+}
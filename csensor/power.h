@@ -0,0 +1,35 @@
+/**
+ * Low-Power Scheduling for CloudPico
+ *
+ * In LOW_POWER builds (-DLOW_POWER=ON at configure time) the firmware runs
+ * the BME280 in forced mode — one conversion per poll, sensor asleep in
+ * between — and drops the sampling core into deep sleep (SLEEPDEEP + WFI
+ * with a timer-alarm wake) between polls. cyw43/BTstack stay on core 0 and
+ * keep being serviced normally, so BLE advertising resumes cleanly after
+ * every wake.
+ *
+ * Without LOW_POWER the same entry points fall back to plain sleep_until(),
+ * so callers never need to branch on the build profile.
+ */
+
+#ifndef _POWER_H
+#define _POWER_H
+
+#include "pico/stdlib.h"
+
+/**
+ * Report the selected power profile over stdio at boot.
+ */
+void power_init(void);
+
+/**
+ * Sleep the calling core until the given deadline.
+ *
+ * LOW_POWER builds gate the core's clock tree via SLEEPDEEP and wake on the
+ * timer alarm; otherwise this is a plain sleep_until(). Only the sampling
+ * core (core 1) should use this — core 0 must keep pumping the cyw43 async
+ * context.
+ */
+void power_sleep_until(absolute_time_t until);
+
+#endif /* _POWER_H */
@@ -0,0 +1,129 @@
+/**
+ * Persistent Reading Sequence Implementation for CloudPico
+ *
+ * See reading_seq.h for the recovery model. The flash side follows the
+ * other top-of-flash consumers: memory-mapped reads via XIP, writes
+ * through flash_safe_execute().
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "hardware/flash.h"
+#include "hardware/watchdog.h"
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "calib_cache.h"
+#include "flash_store.h"
+#include "reading_seq.h"
+#include "wdt.h"
+
+// Placement: the sector directly below the calibration cache
+#define SEQ_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE - CALIB_CACHE_SIZE - FLASH_SECTOR_SIZE)
+
+// One counter cell per page so each write is a fresh, aligned program
+#define CELL_COUNT (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define CELL_MAGIC 0x53455131u  // "SEQ1"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t boundary;  // highest READING_SEQ_BATCH boundary crossed
+} seq_cell_t;
+
+// Next flash cell to program and the boundary already recorded
+static uint32_t next_cell = 0;
+static uint32_t recorded_boundary = 0;
+
+static const seq_cell_t *cell_at(uint32_t idx) {
+    return (const seq_cell_t *)(XIP_BASE + SEQ_OFFSET + idx * FLASH_PAGE_SIZE);
+}
+
+struct flash_op {
+    uint32_t offset;
+    const uint8_t *data;
+    size_t len;
+};
+
+static void do_flash_program(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_program(op->offset, op->data, op->len);
+}
+
+static void do_flash_erase(void *param) {
+    struct flash_op *op = (struct flash_op *)param;
+    flash_range_erase(op->offset, op->len);
+}
+
+/**
+ * Append a counter cell recording the given boundary, erasing the sector
+ * when all cells are used (the new cell then restarts at index 0).
+ */
+static void record_boundary(uint32_t boundary) {
+    if (next_cell == CELL_COUNT) {
+        struct flash_op op = {
+            .offset = SEQ_OFFSET,
+            .data = NULL,
+            .len = FLASH_SECTOR_SIZE,
+        };
+        if (flash_safe_execute(do_flash_erase, &op, UINT32_MAX) != PICO_OK) {
+            printf("Reading seq: counter sector erase failed\n");
+            return;
+        }
+        next_cell = 0;
+    }
+
+    uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    seq_cell_t cell = { .magic = CELL_MAGIC, .boundary = boundary };
+    memcpy(page, &cell, sizeof(cell));
+
+    struct flash_op op = {
+        .offset = SEQ_OFFSET + next_cell * FLASH_PAGE_SIZE,
+        .data = page,
+        .len = FLASH_PAGE_SIZE,
+    };
+    if (flash_safe_execute(do_flash_program, &op, UINT32_MAX) != PICO_OK) {
+        printf("Reading seq: counter cell program failed\n");
+        return;
+    }
+    next_cell++;
+    recorded_boundary = boundary;
+}
+
+uint32_t reading_seq_init(void) {
+    // Scan the counter sector for the newest valid cell; cells are written
+    // in order, so the first erased slot ends the scan
+    uint32_t flash_boundary = 0;
+    bool have_flash = false;
+    for (next_cell = 0; next_cell < CELL_COUNT; next_cell++) {
+        const seq_cell_t *c = cell_at(next_cell);
+        if (c->magic != CELL_MAGIC) {
+            break;
+        }
+        flash_boundary = c->boundary;
+        have_flash = true;
+    }
+    recorded_boundary = flash_boundary;
+
+    // Warm reset: scratch[3] still holds the exact highest ID issued
+    if (wdt_scratch_valid()) {
+        uint32_t floor = watchdog_hw->scratch[3];
+        printf("Reading seq: resuming at %u (scratch)\n", (unsigned)floor);
+        return floor;
+    }
+
+    // Cold boot: resume a full batch above the last recorded boundary so
+    // anything issued since that cell was written is safely below us
+    uint32_t floor = have_flash ? flash_boundary + READING_SEQ_BATCH : 0;
+    printf("Reading seq: resuming at %u (flash)\n", (unsigned)floor);
+    return floor;
+}
+
+void reading_seq_note(uint32_t id) {
+    if (id > watchdog_hw->scratch[3]) {
+        watchdog_hw->scratch[3] = id;
+    }
+    uint32_t boundary = id - (id % READING_SEQ_BATCH);
+    if (boundary > recorded_boundary) {
+        record_boundary(boundary);
+    }
+}
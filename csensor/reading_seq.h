@@ -0,0 +1,44 @@
+/**
+ * Persistent Reading Sequence for CloudPico
+ *
+ * The gateway's dedup/loss-accounting pipeline is keyed on
+ * device_id + reading_id, so counters restarting at 0 after a reset
+ * double-count or discard readings. This module keeps the reading
+ * counters monotonic for the life of the device:
+ *
+ * - Warm resets (watchdog, soft reset): the highest ID issued so far is
+ *   mirrored into watchdog scratch[3] on every issue and recovered
+ *   exactly, validated by the wdt scratch magic.
+ * - Cold boots (power loss clears scratch): a wear-batched flash counter
+ *   records each READING_SEQ_BATCH boundary crossed; recovery resumes
+ *   one full batch above the last recorded boundary, skipping at most
+ *   one batch worth of IDs. Forward jumps are harmless to dedup.
+ *
+ * The counter sector sits directly below the calibration cache; one cell
+ * per flash page keeps programming page-aligned, giving 16 cells per
+ * erase cycle.
+ */
+
+#ifndef READING_SEQ_H
+#define READING_SEQ_H
+
+#include <stdint.h>
+
+// IDs issued between flash counter updates. Larger values trade a bigger
+// cold-boot ID skip for fewer flash writes.
+#define READING_SEQ_BATCH 256
+
+/**
+ * Recover the sequence floor from scratch or flash. Returns the value all
+ * per-sensor reading counters must start from; every ID issued afterwards
+ * is strictly greater than any ID issued before the reset.
+ */
+uint32_t reading_seq_init(void);
+
+/**
+ * Record a freshly issued reading ID. Updates the scratch mirror on every
+ * call and appends a flash cell when a batch boundary is crossed.
+ */
+void reading_seq_note(uint32_t id);
+
+#endif // READING_SEQ_H
@@ -0,0 +1,74 @@
+/**
+ * Periodic Task Scheduler Implementation for CloudPico
+ *
+ * See sched.h for the model. Registration keeps a small registry so the
+ * periodic report can walk every task without the callers wiring it up.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "sched.h"
+
+#define SCHED_MAX_TASKS 8
+#define SCHED_REPORT_INTERVAL_MS 30000
+
+static sched_task_t *tasks[SCHED_MAX_TASKS];
+static uint32_t task_count = 0;
+
+static absolute_time_t next_report;
+
+static void sched_worker_fn(async_context_t *ctx, async_at_time_worker_t *worker) {
+    sched_task_t *t = (sched_task_t *)worker->user_data;
+
+    // Miss accounting against the deadline this run was due at
+    int64_t late_us = absolute_time_diff_us(t->deadline, get_absolute_time());
+    if (late_us > (int64_t)t->slack_ms * 1000) {
+        t->misses++;
+    }
+    if (late_us > 0 && (uint32_t)(late_us / 1000) > t->worst_late_ms) {
+        t->worst_late_ms = (uint32_t)(late_us / 1000);
+    }
+    t->runs++;
+
+    // Fixed cadence: advance from the previous deadline so lateness in one
+    // run doesn't shift every following one
+    t->deadline = delayed_by_ms(t->deadline, t->interval_ms);
+    async_context_add_at_time_worker_at(ctx, worker, t->deadline);
+
+    t->fn();
+}
+
+void sched_task_start(async_context_t *ctx, sched_task_t *task, const char *name,
+                      void (*fn)(void), uint32_t interval_ms, uint32_t slack_ms) {
+    task->ctx = ctx;
+    task->fn = fn;
+    task->interval_ms = interval_ms;
+    task->slack_ms = slack_ms;
+    task->runs = 0;
+    task->misses = 0;
+    task->worst_late_ms = 0;
+    task->name = name;
+    task->worker.do_work = sched_worker_fn;
+    task->worker.user_data = task;
+
+    if (task_count < SCHED_MAX_TASKS) {
+        tasks[task_count++] = task;
+    }
+
+    task->deadline = make_timeout_time_ms(interval_ms);
+    async_context_add_at_time_worker_at(ctx, &task->worker, task->deadline);
+}
+
+void sched_report_maybe(void) {
+    if (!time_reached(next_report)) {
+        return;
+    }
+    next_report = make_timeout_time_ms(SCHED_REPORT_INTERVAL_MS);
+
+    for (uint32_t i = 0; i < task_count; i++) {
+        sched_task_t *t = tasks[i];
+        printf("sched: %-8s runs=%lu misses=%lu worst_late=%lums\n",
+               t->name, (unsigned long)t->runs, (unsigned long)t->misses,
+               (unsigned long)t->worst_late_ms);
+    }
+}
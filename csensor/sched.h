@@ -0,0 +1,47 @@
+/**
+ * Periodic Task Scheduler for CloudPico
+ *
+ * Thin layer over the Pico SDK async_context at_time workers that core 0
+ * already pumps for cyw43/BTstack. Each task runs on a fixed cadence
+ * (deadlines advance by the interval, not from the completion time, so
+ * they never drift) and keeps deadline-miss accounting: a run starting
+ * more than its slack past the deadline counts as a miss. That turns
+ * latency tuning into per-task budget management instead of superloop
+ * archaeology — a growing miss counter names the task being starved.
+ *
+ * Tasks run on the core that polls the context; handlers must not block.
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include "pico/async_context.h"
+
+typedef struct sched_task {
+    async_at_time_worker_t worker;  // must be first: worker user_data links back
+    async_context_t *ctx;
+    void (*fn)(void);
+    uint32_t interval_ms;
+    uint32_t slack_ms;        // lateness tolerated before counting a miss
+    absolute_time_t deadline; // when the current run was due
+    uint32_t runs;
+    uint32_t misses;
+    uint32_t worst_late_ms;
+    const char *name;
+} sched_task_t;
+
+/**
+ * Register a task and schedule its first run one interval from now.
+ * The task structure must stay alive; fn runs on the polling core.
+ */
+void sched_task_start(async_context_t *ctx, sched_task_t *task, const char *name,
+                      void (*fn)(void), uint32_t interval_ms, uint32_t slack_ms);
+
+/**
+ * Print one line per task (runs, misses, worst lateness) at most every
+ * 30 seconds; call from a periodic task alongside perf_report_maybe().
+ */
+void sched_report_maybe(void);
+
+#endif // SCHED_H
@@ -0,0 +1,396 @@
+/**
+ * Multi-Sensor I2C Bus Manager for CloudPico
+ *
+ * See sensor_bus.h for the pipelining model. All entry points run on the
+ * sampling core (core 1 after launch); the manager owns every BME280
+ * context and the Bosch device structures.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "bme280.h"
+#ifdef SENSOR_SPI
+#include "bme280_pico_spi.h"
+#else
+#include "hardware/i2c.h"
+#include "bme280_pico_i2c.h"
+#endif
+#include "calib_cache.h"
+#include "config.h"
+#include "perf.h"
+#include "sensor_bus.h"
+#include "wdt.h"
+
+#ifdef SENSOR_SPI
+
+// SPI pin assignment (spi0 default mapping; see PINOUT.md)
+#define SPI0_MISO_PIN 16  // GP16 (Pin 21)
+#define SPI0_SCK_PIN 18   // GP18 (Pin 24)
+#define SPI0_MOSI_PIN 19  // GP19 (Pin 25)
+
+// BME280 tops out at 10 MHz SPI
+#define SPI_BUS_FREQ (10 * 1000 * 1000)
+
+// Compile-time device table: one row per possible sensor position. All
+// sensors share the spi0 block; each row only adds a chip-select line.
+static const struct {
+    spi_inst_t *spi;
+    uint csn_pin;
+    const char *label;
+} sensor_table[] = {
+    { spi0, 17, "inside" },   // GP17 (Pin 22)
+    { spi0, 20, "outside" },  // GP20 (Pin 26)
+};
+
+#else
+
+// I2C pin assignment per block (see PINOUT.md)
+#define I2C0_SDA_PIN 16   // GP16 (Pin 21)
+#define I2C0_SCL_PIN 17   // GP17 (Pin 22)
+#define I2C1_SDA_PIN 18   // GP18 (Pin 24)
+#define I2C1_SCL_PIN 19   // GP19 (Pin 25)
+
+// Compile-time device table: one row per possible sensor position.
+// Enclosure wiring: inside sensor at 0x76, outside sensor at 0x77, both on
+// i2c0. Additional i2c1 sensors only need a row here.
+static const struct {
+    i2c_inst_t *i2c;
+    uint8_t addr;
+    uint sda_pin;
+    uint scl_pin;
+    const char *label;
+} sensor_table[] = {
+    { i2c0, 0x76, I2C0_SDA_PIN, I2C0_SCL_PIN, "inside" },
+    { i2c0, 0x77, I2C0_SDA_PIN, I2C0_SCL_PIN, "outside" },
+};
+
+#endif
+
+#define SENSOR_TABLE_LEN count_of(sensor_table)
+
+// Conversion profiles, selected per deployment role by the runtime config
+// (config_get()->profile; the compile-time SENSOR_PROFILE is its default).
+// The worst-case conversion time is recomputed from the chosen
+// oversampling via bme280_cal_meas_delay(), so the sampling wait budget
+// and the raw-capture warmup scale with it.
+//
+//  fast      x1 everywhere, filter off — shortest conversion, noisiest
+//            output; the profile to pair with raw burst capture
+//  balanced  x2 T, x4 P, x2 H, filter 2 — indoor nodes, no gateway-side
+//            smoothing needed
+//  precise   x2 T, x16 P, x1 H, filter 16 — the datasheet's indoor-
+//            navigation weighting; weather nodes wanting pressure to
+//            ~0.2 Pa RMS, pairs with window aggregation
+static const struct {
+    const char *name;
+    uint8_t osr_t, osr_p, osr_h, filter;
+} profiles[CONFIG_PROFILE_COUNT] = {
+    [CONFIG_PROFILE_FAST] = { "fast", BME280_OVERSAMPLING_1X, BME280_OVERSAMPLING_1X,
+                              BME280_OVERSAMPLING_1X, BME280_FILTER_COEFF_OFF },
+    [CONFIG_PROFILE_BALANCED] = { "balanced", BME280_OVERSAMPLING_2X, BME280_OVERSAMPLING_4X,
+                                  BME280_OVERSAMPLING_2X, BME280_FILTER_COEFF_2 },
+    [CONFIG_PROFILE_PRECISE] = { "precise", BME280_OVERSAMPLING_2X, BME280_OVERSAMPLING_16X,
+                                 BME280_OVERSAMPLING_1X, BME280_FILTER_COEFF_16 },
+};
+
+// Stable per-slot bus identity: I2C address, or chip-select pin on SPI.
+// Used in diagnostics and as the calibration cache key.
+#ifdef SENSOR_SPI
+#define SLOT_BUS_KEY(idx) ((uint8_t)sensor_table[idx].csn_pin)
+#else
+#define SLOT_BUS_KEY(idx) (sensor_table[idx].addr)
+#endif
+
+// Per-slot runtime state
+static struct sensor_slot {
+    struct bme280_dev dev;
+#ifdef SENSOR_SPI
+    struct bme280_pico_spi_context spi_ctx;
+#else
+    struct bme280_pico_i2c_context i2c_ctx;
+#endif
+    bool present;
+    uint32_t meas_delay_us;   // worst-case conversion time for its settings
+} slots[SENSOR_TABLE_LEN];
+
+static uint8_t present_count = 0;
+
+/**
+ * Poll one sensor's status register until its conversion finishes, with
+ * exponential backoff. Mirrors the single-sensor path: first check after
+ * the remaining budget is expected to be spent, bail at 2x worst case.
+ */
+static int8_t wait_measurement_done(struct sensor_slot *s, uint32_t already_waited_us) {
+    uint8_t status;
+    int8_t rslt;
+    uint32_t backoff_us = 250;
+    uint32_t waited_us = already_waited_us;
+    uint32_t budget_us = s->meas_delay_us * 2 + 1000;
+
+    while (1) {
+        rslt = bme280_get_regs(BME280_REG_STATUS, &status, 1, &s->dev);
+        if (rslt != BME280_OK) {
+            return rslt;
+        }
+        if ((status & BME280_STATUS_MEAS_DONE) == 0) {
+            return BME280_OK;
+        }
+        if (waited_us >= budget_us) {
+            return BME280_E_COMM_FAIL;
+        }
+        s->dev.delay_us(backoff_us, s->dev.intf_ptr);
+        waited_us += backoff_us;
+        if (backoff_us < 4000) {
+            backoff_us *= 2;
+        }
+    }
+}
+
+/**
+ * Rescale the Bosch fixed-point output to wire units — integer arithmetic
+ * only, no soft-float on the hot path.
+ */
+static void convert_comp_data(const struct bme280_data *comp_data, sensor_data_t *out) {
+    #ifdef BME280_DOUBLE_ENABLE
+    out->temp_centi = (int32_t)(comp_data->temperature * 100.0);
+    out->press_deci = (int32_t)(comp_data->pressure / 10.0);   // Pa to deci-hPa
+    out->hum_centi = (int32_t)(comp_data->humidity * 100.0);
+    #else
+    out->temp_centi = comp_data->temperature;                  // already centi-degC
+    out->press_deci = (int32_t)(comp_data->pressure / 10);     // Pa to deci-hPa
+    out->hum_centi = (int32_t)((comp_data->humidity * 25) >> 8);  // Q22.10 to centi-%RH
+    #endif
+}
+
+/**
+ * Initialize and configure one slot. Returns false if the sensor is absent
+ * or failed configuration.
+ */
+static bool init_slot(uint8_t idx) {
+    struct sensor_slot *s = &slots[idx];
+    int8_t rslt;
+
+#ifdef SENSOR_SPI
+    bme280_pico_spi_init(&s->spi_ctx, sensor_table[idx].spi, SPI0_SCK_PIN,
+                         SPI0_MOSI_PIN, SPI0_MISO_PIN, sensor_table[idx].csn_pin,
+                         SPI_BUS_FREQ);
+
+    s->dev.intf = BME280_SPI_INTF;
+    s->dev.read = bme280_pico_spi_read;
+    s->dev.write = bme280_pico_spi_write;
+    s->dev.delay_us = bme280_pico_spi_delay_us;
+    s->dev.intf_ptr = &s->spi_ctx;
+#else
+    bme280_pico_i2c_init(&s->i2c_ctx, sensor_table[idx].i2c, sensor_table[idx].addr,
+                         sensor_table[idx].sda_pin, sensor_table[idx].scl_pin, 100 * 1000);
+
+    s->dev.intf = BME280_I2C_INTF;
+    s->dev.read = bme280_pico_i2c_read;
+    s->dev.write = bme280_pico_i2c_write;
+    s->dev.delay_us = bme280_pico_delay_us;
+    s->dev.intf_ptr = &s->i2c_ctx;
+#endif
+
+    // Warm path: probe the chip ID with a single register read and reuse
+    // cached calibration data, skipping bme280_init()'s soft reset and
+    // full calibration block readout over the still-100 kHz bus
+    uint8_t chip_id;
+    rslt = bme280_get_regs(BME280_REG_CHIP_ID, &chip_id, 1, &s->dev);
+    if (rslt == BME280_OK && chip_id == BME280_CHIP_ID &&
+        calib_cache_load(SLOT_BUS_KEY(idx), chip_id, &s->dev.calib_data)) {
+        s->dev.chip_id = chip_id;
+        printf("Sensor bus: %s sensor calibration from cache\n", sensor_table[idx].label);
+    } else {
+        rslt = bme280_init(&s->dev);
+        if (rslt != BME280_OK) {
+            printf("Sensor bus: no %s sensor at 0x%02X (error %d)\n",
+                   sensor_table[idx].label, SLOT_BUS_KEY(idx), rslt);
+            return false;
+        }
+        calib_cache_store(SLOT_BUS_KEY(idx), s->dev.chip_id, &s->dev.calib_data);
+    }
+
+    // Apply the deployment profile (see the table above). Profile changes
+    // over GATT land in the config before this init runs, i.e. next boot.
+    uint8_t pidx = config_get()->profile;
+    struct bme280_settings settings;
+    settings.osr_p = profiles[pidx].osr_p;
+    settings.osr_t = profiles[pidx].osr_t;
+    settings.osr_h = profiles[pidx].osr_h;
+    settings.filter = profiles[pidx].filter;
+    settings.standby_time = BME280_STANDBY_TIME_0_5_MS;
+
+    rslt = bme280_set_sensor_settings(BME280_SEL_ALL_SETTINGS, &settings, &s->dev);
+    if (rslt != BME280_OK) {
+        printf("Sensor bus: failed to configure %s sensor (error %d)\n",
+               sensor_table[idx].label, rslt);
+        return false;
+    }
+
+    rslt = bme280_cal_meas_delay(&s->meas_delay_us, &settings);
+    if (rslt != BME280_OK) {
+        printf("Sensor bus: failed to compute delay for %s sensor (error %d)\n",
+               sensor_table[idx].label, rslt);
+        return false;
+    }
+
+    printf("Sensor bus: %s sensor at 0x%02X ready (chip 0x%02X, profile %s, delay %lu us)\n",
+           sensor_table[idx].label, SLOT_BUS_KEY(idx),
+           s->dev.chip_id, profiles[pidx].name, s->meas_delay_us);
+    return true;
+}
+
+int sensor_bus_init(void) {
+#ifndef SENSOR_SPI
+    bool block_negotiated[2] = {false, false};
+#endif
+
+    present_count = 0;
+    for (uint8_t i = 0; i < SENSOR_TABLE_LEN; i++) {
+        slots[i].present = init_slot(i);
+#ifndef SENSOR_SPI
+        if (slots[i].present) {
+            present_count++;
+            // Negotiate the shared block speed once, with the first sensor
+            // found on it; later sensors ride the verified rate. SPI builds
+            // run the fixed 10 MHz maximum and have nothing to negotiate.
+            uint block = i2c_hw_index(sensor_table[i].i2c);
+            if (!block_negotiated[block]) {
+                bme280_pico_i2c_negotiate_speed(&slots[i].i2c_ctx);
+                block_negotiated[block] = true;
+            }
+        }
+#else
+        if (slots[i].present) {
+            present_count++;
+        }
+#endif
+    }
+
+    if (present_count == 0) {
+        printf("Sensor bus: no sensors found\n");
+        return -1;
+    }
+    printf("Sensor bus: %u sensor(s) online\n", present_count);
+    return present_count;
+}
+
+int sensor_bus_sample_all(sensor_bus_reading_t *out) {
+    int produced = 0;
+    int8_t rslt;
+    uint32_t max_delay_us = 0;
+
+    // Phase 1: kick a forced conversion on every sensor back-to-back; the
+    // conversions then run concurrently inside the sensors
+    for (uint8_t i = 0; i < SENSOR_TABLE_LEN; i++) {
+        if (!slots[i].present) continue;
+        rslt = bme280_set_sensor_mode(BME280_POWERMODE_FORCED, &slots[i].dev);
+        if (rslt != BME280_OK) {
+            printf("Sensor bus: failed to trigger sensor %u (error %d)\n", i, rslt);
+            continue;
+        }
+        if (slots[i].meas_delay_us > max_delay_us) {
+            max_delay_us = slots[i].meas_delay_us;
+        }
+    }
+
+    // Phase 2: sleep through the shared half-budget once, then confirm each
+    // sensor via its status register
+    uint32_t head_start_us = max_delay_us / 2;
+    sleep_us(head_start_us);
+
+    // Phase 3: read everything out
+    for (uint8_t i = 0; i < SENSOR_TABLE_LEN; i++) {
+        if (!slots[i].present) continue;
+
+        if (wait_measurement_done(&slots[i], head_start_us) != BME280_OK) {
+            printf("Sensor bus: sensor %u measurement did not complete\n", i);
+            continue;
+        }
+
+        struct bme280_data comp_data;
+        wdt_stage(1, WDT_STAGE_COMPENSATE);
+        uint32_t t0 = perf_begin();
+        rslt = bme280_get_sensor_data(BME280_ALL, &comp_data, &slots[i].dev);
+        perf_end(PERF_COMPENSATE, t0);
+        wdt_stage(1, WDT_STAGE_I2C_XFER);
+        if (rslt != BME280_OK) {
+            printf("Sensor bus: sensor %u readout failed (error %d)\n", i, rslt);
+            continue;
+        }
+
+        out[produced].sensor_id = i;
+        convert_comp_data(&comp_data, &out[produced].data);
+        produced++;
+    }
+
+    return produced;
+}
+
+int sensor_bus_capture_raw(uint8_t sensor_id, sensor_raw_frame_t *frames,
+                           uint32_t count, uint32_t interval_us) {
+    if (sensor_id >= SENSOR_TABLE_LEN || !slots[sensor_id].present) {
+        return -1;
+    }
+    struct sensor_slot *s = &slots[sensor_id];
+
+    // Cyclic conversions: the sensor free-runs with its configured
+    // oversampling and minimal standby while we burst-read frames
+    if (bme280_set_sensor_mode(BME280_POWERMODE_NORMAL, &s->dev) != BME280_OK) {
+        return -1;
+    }
+
+    // Let the first conversion finish so frame 0 isn't stale sleep data
+    s->dev.delay_us(s->meas_delay_us, s->dev.intf_ptr);
+
+    absolute_time_t next = get_absolute_time();
+    uint32_t captured = 0;
+    while (captured < count) {
+        #ifdef SENSOR_SPI
+        // SPI is already ~10 us per burst; the generic register read is the
+        // fast path
+        if (bme280_get_regs(BME280_REG_DATA, frames[captured].regs,
+                            sizeof(frames[captured].regs), &s->dev) != BME280_OK) {
+            break;
+        }
+        #else
+        if (bme280_pico_i2c_read_burst(&s->i2c_ctx, frames[captured].regs)
+                != BME280_INTF_RET_SUCCESS) {
+            break;
+        }
+        #endif
+        captured++;
+        next = delayed_by_us(next, interval_us);
+        sleep_until(next);
+    }
+
+    // Back to sleep; the regular forced-mode cycle owns the sensor again
+    bme280_set_sensor_mode(BME280_POWERMODE_SLEEP, &s->dev);
+    return (int)captured;
+}
+
+int sensor_bus_compensate_raw(uint8_t sensor_id, const sensor_raw_frame_t *frame,
+                              sensor_data_t *out) {
+    if (sensor_id >= SENSOR_TABLE_LEN || !slots[sensor_id].present) {
+        return -1;
+    }
+
+    struct bme280_uncomp_data uncomp;
+    struct bme280_data comp;
+    bme280_parse_sensor_data(frame->regs, &uncomp);
+
+    uint32_t t0 = perf_begin();
+    int8_t rslt = bme280_compensate_data(BME280_ALL, &uncomp, &comp,
+                                         &slots[sensor_id].dev.calib_data);
+    perf_end(PERF_COMPENSATE, t0);
+    if (rslt != BME280_OK) {
+        return -1;
+    }
+
+    convert_comp_data(&comp, out);
+    return 0;
+}
+
+uint8_t sensor_bus_device_count(void) {
+    return present_count;
+}
@@ -0,0 +1,86 @@
+/**
+ * Multi-Sensor I2C Bus Manager for CloudPico
+ *
+ * Owns up to SENSOR_BUS_MAX_DEVICES BME280 contexts across both RP2040 I2C
+ * blocks and pipelines their conversions: every present sensor is kicked
+ * into a forced conversion back-to-back, the (shared) conversion window is
+ * waited out once, then the results are read out in turn. Total cycle time
+ * therefore scales with one conversion window plus N readouts instead of N
+ * full serialized read cycles.
+ *
+ * The device table is compile-time: our enclosures carry the inside sensor
+ * at 0x76 and the outside sensor at 0x77 on i2c0; additional sensors on
+ * i2c1 only need a table entry. Absent sensors are detected at probe time
+ * and skipped.
+ */
+
+#ifndef _SENSOR_BUS_H
+#define _SENSOR_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_advertise.h"
+
+#define SENSOR_BUS_MAX_DEVICES 4
+
+// One compensated reading tagged with its originating sensor slot
+typedef struct {
+    uint8_t sensor_id;    // index into the device table
+    sensor_data_t data;
+} sensor_bus_reading_t;
+
+// One uncompensated burst frame: raw bytes of registers 0xF7..0xFE
+// (pressure, temperature, humidity). 8 bytes against 12 for a compensated
+// reading, and no 64-bit compensation math spent on frames that will be
+// downsampled away.
+typedef struct {
+    uint8_t regs[8];
+} sensor_raw_frame_t;
+
+/**
+ * Probe the device table and initialize every sensor found.
+ * @return Number of sensors present, or negative if none initialized
+ */
+int sensor_bus_init(void);
+
+/**
+ * Run one interleaved sampling cycle: kick all conversions, wait for
+ * completion, read everything out.
+ * @param out Array of at least SENSOR_BUS_MAX_DEVICES readings
+ * @return Number of readings produced
+ */
+int sensor_bus_sample_all(sensor_bus_reading_t *out);
+
+/**
+ * High-rate raw capture: put one sensor into cyclic (normal) mode and
+ * burst-read raw frames into the caller's ring at a fixed cadence, then
+ * return it to sleep. No compensation runs during capture; apply
+ * sensor_bus_compensate_raw() afterwards to the frames worth keeping
+ * (event triggers, downsampled survivors).
+ *
+ * Runs on the sampling core and monopolizes the bus for the duration, so
+ * size count * interval_us accordingly (e.g. 64 frames at 100 ms for a
+ * 6.4 s draft-detection window).
+ *
+ * @param sensor_id Slot to capture from
+ * @param frames Caller-supplied ring of at least count frames
+ * @param count Frames to capture
+ * @param interval_us Capture cadence (>= the sensor's conversion time)
+ * @return Number of frames captured, or negative on error
+ */
+int sensor_bus_capture_raw(uint8_t sensor_id, sensor_raw_frame_t *frames,
+                           uint32_t count, uint32_t interval_us);
+
+/**
+ * Compensate one raw frame into wire units using the slot's calibration.
+ * @return 0 on success, negative if the slot is absent
+ */
+int sensor_bus_compensate_raw(uint8_t sensor_id, const sensor_raw_frame_t *frame,
+                              sensor_data_t *out);
+
+/**
+ * Number of sensors found at init time.
+ */
+uint8_t sensor_bus_device_count(void);
+
+#endif /* _SENSOR_BUS_H */
@@ -0,0 +1,70 @@
+/**
+ * Lock-free SPSC reading queue for CloudPico
+ *
+ * Single-producer/single-consumer ring buffer carrying compensated sensor
+ * readings from the core-1 sensor task to the core-0 BLE task. Producer only
+ * writes the head index, consumer only writes the tail index, so no locks or
+ * spinlocks are needed — just data memory barriers around the index updates.
+ */
+
+#ifndef _SENSOR_QUEUE_H
+#define _SENSOR_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "sensor_bus.h"
+
+// Must be a power of two (index arithmetic uses masking)
+#define SENSOR_QUEUE_CAPACITY 8
+
+/**
+ * SPSC queue of sensor readings. head is owned by the producer (core 1),
+ * tail by the consumer (core 0).
+ */
+typedef struct {
+    sensor_bus_reading_t slots[SENSOR_QUEUE_CAPACITY];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+} sensor_queue_t;
+
+static inline void sensor_queue_init(sensor_queue_t *q) {
+    q->head = 0;
+    q->tail = 0;
+}
+
+/**
+ * Push a reading (producer side, core 1 only).
+ * Returns false if the queue is full; the reading is dropped so a stalled
+ * consumer can never block the sensor pipeline.
+ */
+static inline bool sensor_queue_push(sensor_queue_t *q, const sensor_bus_reading_t *data) {
+    uint32_t head = q->head;
+    uint32_t tail = q->tail;
+    if (head - tail >= SENSOR_QUEUE_CAPACITY) {
+        return false;  // full
+    }
+    q->slots[head & (SENSOR_QUEUE_CAPACITY - 1)] = *data;
+    __dmb();  // slot contents must be visible before the index moves
+    q->head = head + 1;
+    return true;
+}
+
+/**
+ * Pop a reading (consumer side, core 0 only).
+ * Returns false if the queue is empty.
+ */
+static inline bool sensor_queue_pop(sensor_queue_t *q, sensor_bus_reading_t *out) {
+    uint32_t head = q->head;
+    uint32_t tail = q->tail;
+    if (head == tail) {
+        return false;  // empty
+    }
+    __dmb();  // read index before slot contents
+    *out = q->slots[tail & (SENSOR_QUEUE_CAPACITY - 1)];
+    __dmb();
+    q->tail = tail + 1;
+    return true;
+}
+
+#endif /* _SENSOR_QUEUE_H */
@@ -0,0 +1,138 @@
+/**
+ * Core-1 Sensor Task for CloudPico
+ *
+ * Runs the sampling pipeline on core 1: the I2C buses, the bus manager and
+ * the activity LED are owned exclusively by this core. Compensated readings
+ * (tagged with their sensor slot) are pushed through the lock-free SPSC
+ * queue in sensor_queue.h; core 0 (cyw43/BTstack) drains it from its own
+ * loop.
+ *
+ * Initialization runs on core 0 inside sensor_task_launch() so failures can
+ * be reported synchronously; after multicore_launch_core1() the buses must
+ * not be touched from core 0 again.
+ */
+
+#include <stdio.h>
+#include "hardware/gpio.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "config.h"
+#include "log.h"
+#include "perf.h"
+#include "power.h"
+#include "sensor_bus.h"
+#include "sensor_queue.h"
+#include "sensor_task.h"
+#include "wdt.h"
+
+// External LED on GP0 (Physical Pin 1)
+#define LED_PIN 0   // GP0 (Pin 1) - External LED
+
+// Reading queue: core 1 produces, core 0 consumes
+static sensor_queue_t reading_queue;
+
+// Called on core 1 after a cycle that queued readings; wakes core 0's
+// async context so the drain worker runs without a polling tick
+static void (*reading_notifier)(void) = NULL;
+
+// Initialize external LED on GP0
+static void led_init(void) {
+    gpio_init(LED_PIN);
+    gpio_set_dir(LED_PIN, GPIO_OUT);
+    gpio_put(LED_PIN, 0);  // Start with LED off
+}
+
+// Set LED state (true = on, false = off)
+static void led_set(bool on) {
+    gpio_put(LED_PIN, on);
+}
+
+/**
+ * Core 1 entry point: run one interleaved bus cycle at the configured poll
+ * interval and push the readings into the queue. Never returns.
+ */
+static void sensor_core1_entry(void) {
+    sensor_bus_reading_t readings[SENSOR_BUS_MAX_DEVICES];
+    bool led_state = false;
+
+    printf("Sensor: core 1 sampling task started (interval: %lu ms, %u sensor(s))\n",
+           (unsigned long)config_get()->poll_interval_ms, sensor_bus_device_count());
+
+    // Core 0 programs the flash log; this core must be lockout-capable so
+    // XIP can be stalled safely during flash operations
+    flash_safe_execute_core_init();
+
+    // SysTick is per-core: arm this core's counter for the I2C and
+    // compensation sections
+    perf_core_init();
+
+    // No stabilization wait: sensor_bus_init() already completed the full
+    // probe/configure handshake with every sensor on core 0, and BTstack is
+    // still booting on core 0 in parallel — sample immediately so the first
+    // reading is queued by the time advertising comes up.
+    absolute_time_t next_sensor_read = get_absolute_time();
+
+    while (1) {
+        // Deep sleep between polls in LOW_POWER builds, plain sleep otherwise
+        wdt_stage(1, WDT_STAGE_IDLE);
+        power_sleep_until(next_sensor_read);
+        // Cadence re-read each cycle, so a GATT config write takes effect
+        // on the very next sample
+        next_sensor_read = make_timeout_time_ms(config_get()->poll_interval_ms);
+
+        // Toggle LED to show activity
+        led_state = !led_state;
+        led_set(led_state);
+
+        // One interleaved cycle: all conversions kicked up front, one shared
+        // wait, then per-sensor readout. The bus manager refines the stamp
+        // to I2C_XFER/COMPENSATE as it moves through the cycle.
+        wdt_stage(1, WDT_STAGE_I2C_XFER);
+        int produced = sensor_bus_sample_all(readings);
+        wdt_core1_alive();
+
+        for (int i = 0; i < produced; i++) {
+            // Deferred log record; formatting happens on core 0 and only
+            // when a USB host is connected
+            log_event(LOG_EVT_READING, readings[i].sensor_id,
+                      readings[i].data.temp_centi,
+                      readings[i].data.press_deci,
+                      readings[i].data.hum_centi, 0);
+
+            if (!sensor_queue_push(&reading_queue, &readings[i])) {
+                // Core 0 is not draining (e.g. BLE stuck); drop rather than block
+                log_event(LOG_EVT_QUEUE_FULL, readings[i].sensor_id, 0, 0, 0, 0);
+            }
+        }
+
+        if (produced > 0 && reading_notifier != NULL) {
+            reading_notifier();
+        }
+    }
+}
+
+int sensor_task_launch(void) {
+    led_init();
+    printf("LED initialized on GP%d (Pin 1)\n", LED_PIN);
+
+    // Probe the device table and bring up every sensor found
+    if (sensor_bus_init() < 0) {
+        printf("ERROR: No BME280 sensors found. Check I2C connections and sensor power\n");
+        return -1;
+    }
+
+    sensor_queue_init(&reading_queue);
+
+    // Hand the buses and the sampling loop to core 1
+    multicore_launch_core1(sensor_core1_entry);
+    return 0;
+}
+
+bool sensor_task_pop(sensor_bus_reading_t *out) {
+    return sensor_queue_pop(&reading_queue, out);
+}
+
+void sensor_task_set_notifier(void (*fn)(void)) {
+    reading_notifier = fn;
+}
@@ -0,0 +1,39 @@
+/**
+ * Core-1 Sensor Task for CloudPico
+ *
+ * Owns the I2C buses and the sensor bus manager on core 1, sampling at
+ * POLL_INTERVAL_MS and pushing compensated readings through a lock-free
+ * SPSC queue to core 0, which owns cyw43/BTstack. A slow or retried I2C
+ * transaction therefore never delays BLE event servicing.
+ */
+
+#ifndef _SENSOR_TASK_H
+#define _SENSOR_TASK_H
+
+#include <stdbool.h>
+#include "sensor_bus.h"
+
+/**
+ * Launch the sensor pipeline on core 1.
+ *
+ * Probes and initializes the sensor bus and the reading queue, then starts
+ * core 1. Must be called from core 0 before any call to sensor_task_pop().
+ * @return 0 on success, negative if no sensor could be initialized
+ */
+int sensor_task_launch(void);
+
+/**
+ * Pop the next compensated reading produced by core 1 (non-blocking).
+ * @param out Reading destination
+ * @return true if a reading was dequeued, false if none is pending
+ */
+bool sensor_task_pop(sensor_bus_reading_t *out);
+
+/**
+ * Register a callback invoked on core 1 after each cycle that queued
+ * readings, typically to mark a when_pending worker on core 0's async
+ * context. Must be cross-core safe; set before sensor_task_launch().
+ */
+void sensor_task_set_notifier(void (*fn)(void));
+
+#endif /* _SENSOR_TASK_H */
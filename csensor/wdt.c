@@ -0,0 +1,92 @@
+/**
+ * Watchdog Supervision Implementation for CloudPico
+ *
+ * See wdt.h for the supervision model and scratch register layout.
+ */
+
+#include <stdio.h>
+#include "hardware/watchdog.h"
+#include "pico/stdlib.h"
+#include "config.h"
+#include "wdt.h"
+
+// Hardware timeout: core 0 feeds every loop tick (~50 ms), so anything that
+// wedges core 0 for a few seconds is fatal by definition
+#define WDT_TIMEOUT_MS 5000
+
+// Core 1 heartbeats once per sampling cycle; allow one missed cycle plus a
+// worst-case sample before declaring it hung. Derived from the live poll
+// interval so a runtime retune can never starve the feed.
+static inline uint32_t core1_budget_ms(void) {
+    return 2 * config_get()->poll_interval_ms + 2000;
+}
+
+// Marks the stage scratch registers as written by this firmware
+#define WDT_SCRATCH_MAGIC 0x57444754u
+
+static volatile uint32_t core1_heartbeat = 0;
+
+// Core-0 view of core 1's progress
+static uint32_t last_seen_heartbeat = 0;
+static absolute_time_t last_heartbeat_change;
+
+// Diagnostics recovered from the previous run
+static bool last_reset_was_watchdog = false;
+static uint8_t last_stage[2] = { WDT_STAGE_NONE, WDT_STAGE_NONE };
+
+void wdt_init(void) {
+    last_reset_was_watchdog = watchdog_caused_reboot();
+    if (last_reset_was_watchdog && watchdog_hw->scratch[2] == WDT_SCRATCH_MAGIC) {
+        last_stage[0] = (uint8_t)watchdog_hw->scratch[0];
+        last_stage[1] = (uint8_t)watchdog_hw->scratch[1];
+        printf("Watchdog: previous run reset by watchdog (core 0 stage %u, core 1 stage %u)\n",
+               last_stage[0], last_stage[1]);
+    }
+
+    watchdog_hw->scratch[0] = WDT_STAGE_NONE;
+    watchdog_hw->scratch[1] = WDT_STAGE_NONE;
+    watchdog_hw->scratch[2] = WDT_SCRATCH_MAGIC;
+
+    last_heartbeat_change = get_absolute_time();
+
+    // pause_on_debug so a halted debugger doesn't reboot the node under us
+    watchdog_enable(WDT_TIMEOUT_MS, true);
+    printf("Watchdog: armed (%u ms hardware, %u ms core-1 budget)\n",
+           (unsigned)WDT_TIMEOUT_MS, (unsigned)core1_budget_ms());
+}
+
+void wdt_stage(uint8_t core, wdt_stage_t stage) {
+    // Scratch writes are single-cycle APB stores; no synchronization needed
+    // for one register owned by one core
+    watchdog_hw->scratch[core & 1] = stage;
+}
+
+void wdt_core1_alive(void) {
+    core1_heartbeat++;
+}
+
+void wdt_feed(void) {
+    uint32_t beat = core1_heartbeat;
+    if (beat != last_seen_heartbeat) {
+        last_seen_heartbeat = beat;
+        last_heartbeat_change = get_absolute_time();
+    } else if (absolute_time_diff_us(last_heartbeat_change, get_absolute_time())
+               > (int64_t)core1_budget_ms() * 1000) {
+        // Core 1 stopped advancing: withhold the feed and let the watchdog
+        // fire with its last stage stamp still in scratch
+        return;
+    }
+    watchdog_update();
+}
+
+bool wdt_reset_was_watchdog(void) {
+    return last_reset_was_watchdog;
+}
+
+bool wdt_scratch_valid(void) {
+    return watchdog_hw->scratch[2] == WDT_SCRATCH_MAGIC;
+}
+
+uint8_t wdt_last_stage(uint8_t core) {
+    return last_stage[core & 1];
+}
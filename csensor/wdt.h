@@ -0,0 +1,77 @@
+/**
+ * Watchdog Supervision for CloudPico
+ *
+ * Hardware watchdog integration with per-stage deadline accounting. Both
+ * cores stamp the pipeline stage they are entering into watchdog scratch
+ * registers (which survive a watchdog reset); core 0 feeds the watchdog
+ * from its loop, but only while core 1's heartbeat keeps advancing. A
+ * wedged I2C transaction on core 1 (SDA held low by a glitched sensor)
+ * therefore still trips the reset, and the next boot can report which
+ * stage each core was in when the node died.
+ *
+ * Scratch register use: scratch[0] = core 0 stage, scratch[1] = core 1
+ * stage, scratch[2] = validity magic, scratch[3] = reading sequence
+ * mirror (owned by reading_seq.c, validated by the same magic).
+ * scratch[4..7] are reserved by the SDK's watchdog/reboot machinery and
+ * left alone.
+ */
+
+#ifndef WDT_H
+#define WDT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Pipeline stages, stamped per core. Values are persisted across watchdog
+// resets, so renumbering invalidates old field reports — append only.
+typedef enum {
+    WDT_STAGE_NONE = 0,      // before first stamp
+    WDT_STAGE_IDLE = 1,      // sleeping between cycles
+    WDT_STAGE_I2C_XFER = 2,  // core 1: bus transactions / conversion wait
+    WDT_STAGE_COMPENSATE = 3,// core 1: Bosch compensation readout
+    WDT_STAGE_ASYNC_POLL = 4,// core 0: cyw43/BTstack async context
+    WDT_STAGE_ADV_UPDATE = 5,// core 0: advertisement encode + GATT notify
+    WDT_STAGE_FLASH = 6,     // core 0: flash log append/commit
+} wdt_stage_t;
+
+/**
+ * Recover last-run diagnostics from the scratch registers, report them,
+ * and arm the hardware watchdog. Call once on core 0 before the loop.
+ */
+void wdt_init(void);
+
+/**
+ * Stamp the stage a core is entering (core = get_core_num()).
+ */
+void wdt_stage(uint8_t core, wdt_stage_t stage);
+
+/**
+ * Core 1 liveness heartbeat; call once per sampling cycle.
+ */
+void wdt_core1_alive(void);
+
+/**
+ * Feed the hardware watchdog if core 1 is still making progress. Call from
+ * the core-0 loop every iteration; if core 1's heartbeat has not advanced
+ * within its budget the feed is withheld and the watchdog fires.
+ */
+void wdt_feed(void);
+
+/**
+ * Did the last reset come from the watchdog?
+ */
+bool wdt_reset_was_watchdog(void);
+
+/**
+ * True if the scratch registers still carry state written by this
+ * firmware (i.e. the reset was warm; power-up clears them).
+ */
+bool wdt_scratch_valid(void);
+
+/**
+ * Stage a core was in when the watchdog last fired (WDT_STAGE_NONE if the
+ * last reset was not a watchdog reset or predates this firmware).
+ */
+uint8_t wdt_last_stage(uint8_t core);
+
+#endif // WDT_H
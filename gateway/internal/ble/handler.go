@@ -29,13 +29,61 @@ func NewBLESensorHandler(mqttClient *mqtt.Client) *BLESensorHandler {
 }
 
 // HandleMatch processes a BLE match, deduplicates readings, and publishes telemetry.
+// A single v2 advertisement may carry several readings (latest + delta-decoded
+// backfill); each is deduplicated and published independently. v4 status frames
+// are routed to the station status topic instead.
 func (h *BLESensorHandler) HandleMatch(m Match) {
-	sr, err := ParseSensorPayload(m.Data)
+	if IsStatusPayload(m.Data) {
+		h.handleStatus(m)
+		return
+	}
+
+	readings, err := ParseSensorPayload(m.Data)
 	if err != nil {
 		slog.Debug("ble: ignore non-sensor payload", "addr", m.Address, "error", err)
 		return
 	}
 
+	for _, sr := range readings {
+		h.handleReading(m, sr)
+	}
+}
+
+// handleStatus publishes a v4 TX-counter frame to the station's status topic.
+// Status frames carry no sequence number and are retransmitted between counter
+// changes, so they are published retained rather than deduplicated.
+func (h *BLESensorHandler) handleStatus(m Match) {
+	sf, err := ParseStatusPayload(m.Data)
+	if err != nil {
+		slog.Debug("ble: ignore malformed status payload", "addr", m.Address, "error", err)
+		return
+	}
+
+	stationID := fmt.Sprintf("pico-%08X", sf.DeviceID)
+	status := mqtt.StationStatus{
+		StationID:     stationID,
+		Timestamp:     time.Now(),
+		UptimeSeconds: sf.UptimeSeconds,
+		AdvSent:       sf.AdvSent,
+		AdvFail:       sf.AdvFail,
+		StackRestarts: sf.StackRestarts,
+	}
+	if err := h.mqttClient.PublishStationStatus(status); err != nil {
+		slog.Warn("ble: failed to publish station status", "addr", m.Address, "station_id", stationID, "error", err)
+		return
+	}
+	slog.Info("ble: station status published",
+		"addr", m.Address,
+		"station_id", stationID,
+		"rssi", m.RSSI,
+		"uptime_s", sf.UptimeSeconds,
+		"adv_sent", sf.AdvSent,
+		"adv_fail", sf.AdvFail,
+		"stack_restarts", sf.StackRestarts,
+	)
+}
+
+func (h *BLESensorHandler) handleReading(m Match, sr *SensorReading) {
 	h.dedupMu.Lock()
 	deviceKey := fmt.Sprintf("%08X", sr.DeviceID)
 	if h.seen[deviceKey] == nil {
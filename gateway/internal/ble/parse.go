@@ -6,14 +6,78 @@ import (
 	"math"
 )
 
-// Sensor payload format (little-endian): magic 0x01 0xD0, device_id uint32,
-// reading_id uint32, temperature float32, pressure float32, humidity float32 (22 bytes total).
+// Sensor payload formats (little-endian), both starting with magic 0x01 0xD0:
+//
+// v1 (legacy, no version byte): device_id uint32, reading_id uint32,
+// temperature float32, pressure float32, humidity float32 (22 bytes total).
+//
+// v2 (delta batch, version byte 0x02 after the magic): device_id uint32,
+// reading_id uint32 (latest), delta count uint8, latest reading quantized
+// (temp int16 centi-degC, pressure uint16 deci-hPa, humidity uint16
+// centi-%RH), then count * 3 int8 deltas (0.1 degC, 0.1 hPa, 0.25 %RH per
+// LSB) reconstructing readings reading_id-1, reading_id-2, ... so one
+// received advertisement backfills readings lost before it.
+//
+// v3 (window aggregate, version byte 0x03): device_id uint32, reading_id
+// uint32 (newest reading in the window), sample count uint8, then per
+// channel (temperature, pressure, humidity) mean/min/max/std-dev as four
+// 16-bit fields in the v2 wire units (temperature signed). 36 bytes,
+// carried on the extended advertising set only.
+//
+// v4 (TX status, version byte 0x04): device_id uint32, uptime uint32 (s),
+// advertisements sent uint32, set-data failures uint16, stack restarts
+// uint16 (19 bytes). Interleaved every Nth advertisement so the fleet can
+// compute true air-loss rates from per-device transmit counts.
 const (
 	sensorPayloadMagic0 = 0x01
 	sensorPayloadMagic1 = 0xD0
-	sensorPayloadLen    = 22
+	sensorPayloadV1Len  = 22
+
+	sensorPayloadFormatV2 = 0x02
+	sensorPayloadV2Base   = 18
+	sensorPayloadV2Delta  = 3
+	sensorPayloadV2Max    = 16 // max deltas per frame (extended advertising)
+
+	sensorPayloadFormatV3 = 0x03
+	sensorPayloadV3Len    = 36
+
+	sensorPayloadFormatV4 = 0x04
+	sensorPayloadV4Len    = 19
 )
 
+// StatusFrame is a parsed v4 TX-counter advertisement.
+type StatusFrame struct {
+	DeviceID      uint32
+	UptimeSeconds uint32
+	AdvSent       uint32
+	AdvFail       uint16
+	StackRestarts uint16
+}
+
+// IsStatusPayload reports whether manufacturer data is a v4 status frame,
+// so callers can route it to ParseStatusPayload instead of ParseSensorPayload.
+// The exact-length check matters: v1 frames carry no version byte, so a
+// 22-byte legacy frame from a device whose device_id low byte is 0x04 would
+// otherwise match.
+func IsStatusPayload(data []byte) bool {
+	return len(data) == sensorPayloadV4Len && data[0] == sensorPayloadMagic0 &&
+		data[1] == sensorPayloadMagic1 && data[2] == sensorPayloadFormatV4
+}
+
+// ParseStatusPayload parses a v4 TX-counter frame.
+func ParseStatusPayload(data []byte) (*StatusFrame, error) {
+	if !IsStatusPayload(data) {
+		return nil, fmt.Errorf("not a status payload")
+	}
+	return &StatusFrame{
+		DeviceID:      binary.LittleEndian.Uint32(data[3:7]),
+		UptimeSeconds: binary.LittleEndian.Uint32(data[7:11]),
+		AdvSent:       binary.LittleEndian.Uint32(data[11:15]),
+		AdvFail:       binary.LittleEndian.Uint16(data[15:17]),
+		StackRestarts: binary.LittleEndian.Uint16(data[17:19]),
+	}, nil
+}
+
 // SensorReading is a parsed BLE sensor advertisement (device_id + T/P/H + reading_id for dedup).
 type SensorReading struct {
 	DeviceID    uint32
@@ -24,24 +88,125 @@ type SensorReading struct {
 }
 
 // ParseSensorPayload parses manufacturer data from a Pico sensor advertisement.
-// Returns (nil, error) if the payload is not the expected format or length.
-func ParseSensorPayload(data []byte) (*SensorReading, error) {
-	if len(data) < sensorPayloadLen {
+// Returns the carried readings newest-first: a single reading for v1 frames,
+// the latest reading plus any delta-decoded previous readings for v2 frames.
+// Returns (nil, error) if the payload is not an expected format or length.
+//
+// v1 frames have no version byte — data[2] is the device_id low byte — so the
+// version values can collide with legacy frames. Frame lengths disambiguate
+// completely: valid v2 frames are 18+3n bytes (n <= 16), v3 is 36, v4 is 19,
+// and none of those equals the fixed 22-byte v1 length. A version byte is
+// therefore only honored when the length matches its format, and everything
+// else falls through to the v1 parser.
+func ParseSensorPayload(data []byte) ([]*SensorReading, error) {
+	if len(data) < 3 {
 		return nil, fmt.Errorf("payload too short: %d", len(data))
 	}
 	if data[0] != sensorPayloadMagic0 || data[1] != sensorPayloadMagic1 {
 		return nil, fmt.Errorf("invalid magic: %02X %02X", data[0], data[1])
 	}
+	switch data[2] {
+	case sensorPayloadFormatV2:
+		if isV2Len(len(data)) {
+			return parseV2(data)
+		}
+	case sensorPayloadFormatV3:
+		if len(data) == sensorPayloadV3Len {
+			return parseV3(data)
+		}
+	case sensorPayloadFormatV4:
+		if IsStatusPayload(data) {
+			return nil, fmt.Errorf("status payload: use ParseStatusPayload")
+		}
+	}
+	return parseV1(data)
+}
+
+// isV2Len reports whether n is a valid v2 frame length: the 18-byte base
+// plus a whole number of 3-byte deltas, within the extended-frame bound.
+func isV2Len(n int) bool {
+	return n >= sensorPayloadV2Base &&
+		n <= sensorPayloadV2Base+sensorPayloadV2Max*sensorPayloadV2Delta &&
+		(n-sensorPayloadV2Base)%sensorPayloadV2Delta == 0
+}
+
+func parseV1(data []byte) ([]*SensorReading, error) {
+	if len(data) != sensorPayloadV1Len {
+		return nil, fmt.Errorf("unrecognized payload: %d bytes, version byte %02X", len(data), data[2])
+	}
 	deviceID := binary.LittleEndian.Uint32(data[2:6])
 	readingID := binary.LittleEndian.Uint32(data[6:10])
 	temp := math.Float32frombits(binary.LittleEndian.Uint32(data[10:14]))
 	press := math.Float32frombits(binary.LittleEndian.Uint32(data[14:18]))
 	hum := math.Float32frombits(binary.LittleEndian.Uint32(data[18:22]))
-	return &SensorReading{
+	return []*SensorReading{{
 		DeviceID:    deviceID,
 		ReadingID:   readingID,
 		Temperature: float64(temp),
 		Pressure:    float64(press),
 		Humidity:    float64(hum),
-	}, nil
+	}}, nil
+}
+
+func parseV2(data []byte) ([]*SensorReading, error) {
+	deviceID := binary.LittleEndian.Uint32(data[3:7])
+	readingID := binary.LittleEndian.Uint32(data[7:11])
+	deltas := int(data[11])
+	if deltas > sensorPayloadV2Max {
+		return nil, fmt.Errorf("v2 delta count out of range: %d", deltas)
+	}
+	if len(data) != sensorPayloadV2Base+deltas*sensorPayloadV2Delta {
+		return nil, fmt.Errorf("v2 payload length %d does not match %d deltas", len(data), deltas)
+	}
+
+	// Quantized wire units: centi-degC, deci-hPa, centi-%RH
+	tempCenti := int32(int16(binary.LittleEndian.Uint16(data[12:14])))
+	pressDeci := int32(binary.LittleEndian.Uint16(data[14:16]))
+	humCenti := int32(binary.LittleEndian.Uint16(data[16:18]))
+
+	readings := []*SensorReading{{
+		DeviceID:    deviceID,
+		ReadingID:   readingID,
+		Temperature: float64(tempCenti) / 100,
+		Pressure:    float64(pressDeci) / 10,
+		Humidity:    float64(humCenti) / 100,
+	}}
+
+	for i := 0; i < deltas; i++ {
+		d := data[sensorPayloadV2Base+i*sensorPayloadV2Delta:]
+		tempCenti += int32(int8(d[0])) * 10
+		pressDeci += int32(int8(d[1]))
+		humCenti += int32(int8(d[2])) * 25
+		readings = append(readings, &SensorReading{
+			DeviceID:    deviceID,
+			ReadingID:   readingID - uint32(i) - 1,
+			Temperature: float64(tempCenti) / 100,
+			Pressure:    float64(pressDeci) / 10,
+			Humidity:    float64(humCenti) / 100,
+		})
+	}
+	return readings, nil
+}
+
+func parseV3(data []byte) ([]*SensorReading, error) {
+	if len(data) != sensorPayloadV3Len {
+		return nil, fmt.Errorf("v3 payload length %d, want %d", len(data), sensorPayloadV3Len)
+	}
+	deviceID := binary.LittleEndian.Uint32(data[3:7])
+	readingID := binary.LittleEndian.Uint32(data[7:11])
+
+	// Channel layout: mean/min/max/sd, 8 bytes each starting at offset 12.
+	// The window mean is surfaced as a regular reading; min/max/sd wait on
+	// an MQTT schema extension before they can be forwarded.
+	tempCenti := int32(int16(binary.LittleEndian.Uint16(data[12:14])))
+	pressDeci := int32(binary.LittleEndian.Uint16(data[20:22]))
+	humCenti := int32(binary.LittleEndian.Uint16(data[28:30]))
+
+	return []*SensorReading{{
+		DeviceID:    deviceID,
+		ReadingID:   readingID,
+		Temperature: float64(tempCenti) / 100,
+		Pressure:    float64(pressDeci) / 10,
+		Humidity:    float64(humCenti) / 100,
+	}}, nil
 }
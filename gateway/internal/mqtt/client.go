@@ -30,6 +30,18 @@ type StationHealth struct {
 	Healthy   bool      `json:"healthy"`
 }
 
+// StationStatus carries a station's transmit-side counters (the BLE v4
+// status frame), letting the fleet separate air loss — sent but never
+// received — from device stalls.
+type StationStatus struct {
+	StationID     string    `json:"station_id"`
+	Timestamp     time.Time `json:"timestamp"`
+	UptimeSeconds uint32    `json:"uptime_seconds"`
+	AdvSent       uint32    `json:"adv_sent"`
+	AdvFail       uint16    `json:"adv_fail"`
+	StackRestarts uint16    `json:"stack_restarts"`
+}
+
 func NewClient(cfg config.Config) (*Client, error) {
 	c := &Client{
 		cfg:    cfg,
@@ -173,6 +185,41 @@ func (c *Client) PublishStationHealth(health StationHealth) error {
 	return nil
 }
 
+// PublishStationStatus publishes a station's transmit counters, retained
+// so the latest counters are available to late subscribers.
+func (c *Client) PublishStationStatus(status StationStatus) error {
+	if !c.IsConnected() {
+		return fmt.Errorf("mqtt client not connected")
+	}
+
+	topic := fmt.Sprintf("stations/%s/status", status.StationID)
+
+	if status.Timestamp.IsZero() {
+		status.Timestamp = time.Now()
+	}
+
+	data, err := json.Marshal(status)
+	if err != nil {
+		return fmt.Errorf("marshal status: %w", err)
+	}
+
+	token := c.client.Publish(topic, 1, true, data) // retained
+	if !token.WaitTimeout(5 * time.Second) {
+		return fmt.Errorf("publish timeout for topic %s", topic)
+	}
+	if token.Error() != nil {
+		slog.Error("failed to publish station status", "topic", topic, "error", token.Error())
+		return fmt.Errorf("publish status: %w", token.Error())
+	}
+
+	slog.Debug("published station status",
+		"topic", topic,
+		"station_id", status.StationID,
+		"adv_sent", status.AdvSent,
+	)
+	return nil
+}
+
 // IsConnected returns whether the client is connected.
 func (c *Client) IsConnected() bool {
 	c.mu.RLock()